@@ -0,0 +1,289 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include <map>
+#include <thread>
+#include "batch.h"
+#include "grid_kernels.h"
+
+// maximum number of grids of a queue for each solver thread
+const size_t BATCH_ITEMS_PER_THREAD = 64;
+// number of solutions checked at once by the writer
+const size_t BATCH_VERIFY_SIZE = 256;
+
+void BatchQueue_init( BatchQueue& q, size_t capacity, int nbr_producers ) {
+
+	q._capacity = capacity;
+	q._nbr_producers = nbr_producers;
+	q._items.clear();
+
+}
+
+
+void BatchQueue_push( BatchQueue& q, BatchItem& item ) {
+
+	{
+		std::unique_lock<std::mutex> lock( q._mutex );
+
+		while (q._items.size() >= q._capacity) {
+			q._not_full.wait( lock );
+		}
+
+		q._items.push_back( item );
+	}
+
+	q._not_empty.notify_one();
+
+}
+
+
+bool BatchQueue_pop( BatchQueue& q, BatchItem& item ) {
+
+	{
+		std::unique_lock<std::mutex> lock( q._mutex );
+
+		while (q._items.empty() and (q._nbr_producers > 0)) {
+			q._not_empty.wait( lock );
+		}
+
+		if (q._items.empty()) return false;
+
+		item = q._items.front();
+		q._items.pop_front();
+	}
+
+	q._not_full.notify_one();
+
+	return true;
+
+}
+
+
+void BatchQueue_close( BatchQueue& q ) {
+
+	{
+		std::lock_guard<std::mutex> lock( q._mutex );
+		--q._nbr_producers;
+	}
+
+	// wake up all consumers so that they can see the queue is closed
+	q._not_empty.notify_all();
+
+}
+
+/**
+ * Write result of the resolution of a grid
+ */
+static void Batch_write( ostream& out, BatchItem& item ) {
+
+	out << item._nbr_solutions;
+	if (item._nbr_solutions > 0) out << " " << Grid_to_string( item._grid );
+	out << '\n';
+
+}
+
+/**
+ * Check the solutions and clear them, return the number of solutions
+ * that are not satisfied
+ */
+static uint64_t Batch_verify( vector< Grid >& solutions ) {
+
+	vector< int > results( solutions.size() );
+
+	Grid_satisfied_bulk( solutions.data(), static_cast<int>( solutions.size() ), results.data() );
+
+	uint64_t nbr_invalid = 0;
+	for (int r : results) {
+		if (r != SATISFIED) ++nbr_invalid;
+	}
+
+	solutions.clear();
+
+	return nbr_invalid;
+
+}
+
+
+/**
+ * Pipeline where the reader thread calls read( grid ) until it
+ * returns false
+ */
+template<class ReadFunction>
+static uint64_t Batch_run( ReadFunction read, ostream& out, SolverOptions& options,
+		int nbr_threads, bool ordered, bool verify ) {
+
+	if (nbr_threads < 1) nbr_threads = 1;
+
+	SolverOptions solver_options = options;
+	solver_options._parallel = false;
+	solver_options._writer = nullptr;
+
+	size_t capacity = BATCH_ITEMS_PER_THREAD * nbr_threads;
+
+	BatchQueue input, output;
+	BatchQueue_init( input, capacity, 1 );
+	BatchQueue_init( output, capacity, nbr_threads );
+
+	// number of results written, used to limit the number of results
+	// kept by the writer when the output is ordered
+	std::mutex written_mutex;
+	std::condition_variable written_cv;
+	uint64_t nbr_written = 0;
+
+	std::thread reader( [&]() {
+
+		BatchItem item;
+		item._index = 0;
+		item._nbr_solutions = 0;
+
+		while (read( item._grid )) {
+
+			if (ordered) {
+				std::unique_lock<std::mutex> lock( written_mutex );
+				while (item._index >= nbr_written + capacity) {
+					written_cv.wait( lock );
+				}
+			}
+
+			BatchQueue_push( input, item );
+			++item._index;
+		}
+
+		BatchQueue_close( input );
+
+	} );
+
+	std::vector< std::thread > solvers;
+
+	for (int t = 0; t < nbr_threads; ++t) {
+
+		solvers.push_back( std::thread( [&]() {
+
+			BatchItem item;
+			Solver solver;
+			SolverResult result;
+
+			Solver_init( solver, solver_options );
+
+			while (BatchQueue_pop( input, item )) {
+
+				item._nbr_solutions = 0;
+
+				if (Solver_solve( solver, item._grid, result )) {
+					item._nbr_solutions = result._nbr_solutions;
+					if (result._nbr_solutions > 0) {
+						Grid_copy( item._grid, result._first_solution );
+					}
+				}
+
+				BatchQueue_push( output, item );
+			}
+
+			Solver_free( solver );
+
+			BatchQueue_close( output );
+
+		} ) );
+
+	}
+
+	// results that arrived before the results of the previous grids
+	std::map< uint64_t, BatchItem > waiting;
+	uint64_t nbr_results = 0;
+
+	// solutions written and not checked yet
+	vector< Grid > solutions;
+	uint64_t nbr_invalid = 0;
+
+	auto write = [&]( BatchItem& item ) {
+
+		Batch_write( out, item );
+
+		if (verify and (item._nbr_solutions > 0)) {
+			solutions.push_back( item._grid );
+			if (solutions.size() == BATCH_VERIFY_SIZE) {
+				nbr_invalid += Batch_verify( solutions );
+			}
+		}
+
+	};
+
+	BatchItem item;
+
+	while (BatchQueue_pop( output, item )) {
+
+		++nbr_results;
+
+		if (!ordered) {
+			write( item );
+			continue;
+		}
+
+		waiting[ item._index ] = item;
+
+		uint64_t next = nbr_written;
+		auto it = waiting.begin();
+		while ((it != waiting.end()) and (it->first == next)) {
+			write( it->second );
+			it = waiting.erase( it );
+			++next;
+		}
+
+		if (next != nbr_written) {
+			{
+				std::lock_guard<std::mutex> lock( written_mutex );
+				nbr_written = next;
+			}
+			written_cv.notify_one();
+		}
+	}
+
+	reader.join();
+	for (auto& solver : solvers) {
+		solver.join();
+	}
+
+	out.flush();
+
+	if (verify) {
+		nbr_invalid += Batch_verify( solutions );
+		if (nbr_invalid != 0) {
+			cerr << "error: " << nbr_invalid << " solutions are not valid" << endl;
+		}
+	}
+
+	return nbr_results;
+
+}
+
+
+uint64_t Batch_solve( istream& in, ostream& out, SolverOptions& options,
+		int nbr_threads, bool ordered, bool verify ) {
+
+	return Batch_run( [&]( Grid& g ) { return Grid_read( in, g ); },
+		out, options, nbr_threads, ordered, verify );
+
+}
+
+
+uint64_t Batch_solve( PuzzleFile& pf, ostream& out, SolverOptions& options,
+		int nbr_threads, bool ordered, bool verify ) {
+
+	return Batch_run( [&]( Grid& g ) { return PuzzleFile_next( pf, g ); },
+		out, options, nbr_threads, ordered, verify );
+
+}
+
@@ -0,0 +1,102 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include "grid.h"
+#include "solver.h"
+#include "puzzle_file.h"
+
+/**
+ * Resolution of a file of grids with one thread per grid.
+ *
+ * The pipeline has three stages connected by bounded queues:
+ * - a reader thread reads the grids of the input stream
+ * - solver threads take the grids and solve them, each thread has
+ *   its own Solver created with the options of the batch
+ * - a writer thread writes one line per grid with the number of
+ *   solutions followed by the first solution
+ *
+ * When the output is ordered the lines are written in the order of
+ * the grids in the input, the writer keeps the results that arrive
+ * too early and the reader can not be more than the size of the
+ * queues ahead of the writer.
+ */
+
+/**
+ * Grid of the input and result of its resolution, the grid is
+ * replaced by its first solution by the solver
+ */
+typedef struct BatchItem {
+	uint64_t _index;
+	Grid _grid;
+	long _nbr_solutions;
+
+} BatchItem;
+
+/**
+ * Queue with a maximum number of items. The queue is closed when
+ * all its producers have called BatchQueue_close().
+ */
+typedef struct BatchQueue {
+	std::mutex _mutex;
+	std::condition_variable _not_empty;
+	std::condition_variable _not_full;
+	std::deque< BatchItem > _items;
+	size_t _capacity;
+	int _nbr_producers;
+
+} BatchQueue;
+
+/**
+ * Initialize queue with its capacity and its number of producers
+ */
+void BatchQueue_init( BatchQueue& q, size_t capacity, int nbr_producers );
+
+/**
+ * Add item at the end of the queue, wait while the queue is full
+ */
+void BatchQueue_push( BatchQueue& q, BatchItem& item );
+
+/**
+ * Remove the first item of the queue, wait while the queue is empty.
+ * Return false if the queue is empty and closed.
+ */
+bool BatchQueue_pop( BatchQueue& q, BatchItem& item );
+
+/**
+ * Called by a producer that won't push items anymore
+ */
+void BatchQueue_close( BatchQueue& q );
+
+/**
+ * Solve all grids of stream 'in' with 'nbr_threads' solver threads
+ * and write the results to 'out', in the order of the input if
+ * 'ordered' is true. Each grid is solved by one thread with the
+ * options (the parallel search is not used and the solutions are
+ * not given to the writer of the options). If 'verify' is true the
+ * solutions written are checked by groups with Grid_satisfied_bulk()
+ * and the number of invalid solutions is reported. Return the number
+ * of grids solved.
+ */
+uint64_t Batch_solve( istream& in, ostream& out, SolverOptions& options,
+	int nbr_threads, bool ordered = true, bool verify = false );
+
+/**
+ * Solve all grids of the file mapped in memory
+ */
+uint64_t Batch_solve( PuzzleFile& pf, ostream& out, SolverOptions& options,
+	int nbr_threads, bool ordered = true, bool verify = false );
+
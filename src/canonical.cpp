@@ -0,0 +1,487 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include <algorithm>
+#include "canonical.h"
+
+// number of permutations of the columns that keep the stacks:
+// 3! permutations of the stacks and 3! permutations in each stack
+const int NBR_COLUMN_PERMUTATIONS = 6 * 6 * 6 * 6;
+
+// value greater than all values of a cell
+const uint8_t CANONICAL_INFINITY = 0xFF;
+
+typedef struct ColumnPermutations {
+	int8_t _cols[ NBR_COLUMN_PERMUTATIONS ][ MAX_VAL ];
+
+} ColumnPermutations;
+
+static ColumnPermutations ColumnPermutations_build() {
+
+	ColumnPermutations cp;
+
+	int perm[ 3 ] = { 0, 1, 2 };
+	int perms[ 6 ][ 3 ];
+
+	for (int i = 0; i < 6; ++i) {
+		std::copy( perm, perm + 3, perms[ i ] );
+		std::next_permutation( perm, perm + 3 );
+	}
+
+	int n = 0;
+
+	for (int s = 0; s < 6; ++s) {
+		for (int p0 = 0; p0 < 6; ++p0) {
+			for (int p1 = 0; p1 < 6; ++p1) {
+				for (int p2 = 0; p2 < 6; ++p2) {
+
+					int inner[ 3 ] = { p0, p1, p2 };
+
+					for (int k = 0; k < 3; ++k) {
+						int stack = perms[ s ][ k ];
+						for (int j = 0; j < 3; ++j) {
+							cp._cols[ n ][ 3 * k + j ] = 3 * stack + perms[ inner[ k ] ][ j ];
+						}
+					}
+
+					++n;
+				}
+			}
+		}
+	}
+
+	return cp;
+
+}
+
+static const ColumnPermutations column_permutations = ColumnPermutations_build();
+
+// number of permutations of the columns that have the same first
+// 3 (one stack), 6 (two stacks) or 9 columns in column_permutations
+const int COLUMN_PERMUTATIONS_BLOCKS[ 3 ] = { 36, 6, 1 };
+
+/**
+ * Column permutation of the search, with the transposition of the
+ * grid and the labels of the digits of the rows already chosen.
+ * Several candidates give the same rows so far, each one is kept
+ * until a row breaks the tie.
+ */
+typedef struct CanonicalCandidate {
+	uint8_t _transpose;
+	uint8_t _next_label;
+	uint16_t _permutation;
+	uint8_t _labels[ DIM ];
+
+} CanonicalCandidate;
+
+/**
+ * State of the search of the canonical form: the rows of the grid
+ * are chosen one after the other and each row is compared to the
+ * same row of the best grid found so far, for all the candidates
+ * that give the best rows above it
+ */
+typedef struct CanonicalSearch {
+	// cells of the grid and of its transposition
+	uint8_t _cells[ 2 ][ GRID_NBR_CELLS ];
+	// number of givens of each row of the grid and of its
+	// transposition
+	uint8_t _counts[ 2 ][ MAX_VAL ];
+	// numbers of givens of the rows of each band in increasing order
+	uint8_t _bands[ 2 ][ 3 ][ 3 ];
+	// number of givens of each row of the canonical form
+	uint8_t _target[ MAX_VAL ];
+	// smallest grid found so far
+	uint8_t _best[ GRID_NBR_CELLS ];
+
+	int8_t _rows[ MAX_VAL ];
+	// candidates that give the best rows above row r, the last ones
+	// give the best grid
+	vector< CanonicalCandidate > _candidates[ MAX_VAL + 1 ];
+
+	// transformation of the best grid
+	GridTransform _transform;
+
+} CanonicalSearch;
+
+/**
+ * Record the transformation of the current grid, the digits that
+ * don't appear in the grid get the last labels
+ */
+static void CanonicalSearch_record( CanonicalSearch& cs, CanonicalCandidate& cc ) {
+
+	GridTransform& t = cs._transform;
+
+	t._transpose = (cc._transpose != 0);
+
+	for (int i = 0; i < MAX_VAL; ++i) {
+		t._rows[ i ] = cs._rows[ i ];
+		t._cols[ i ] = column_permutations._cols[ cc._permutation ][ i ];
+	}
+
+	t._labels[ ZERO ] = ZERO;
+
+	int next_label = cc._next_label;
+
+	for (int v = MIN_VAL; v <= MAX_VAL; ++v) {
+		t._labels[ v ] = (cc._labels[ v ] != ZERO) ? cc._labels[ v ] : next_label++;
+	}
+
+}
+
+/**
+ * Compare row 'row' of the grid of candidate cc, whose digits are
+ * relabeled, to row r of the best grid. If it is not greater, the
+ * relabeled row is copied in 'line' and the labels of cc are
+ * updated. Return -1 if the row is smaller, 0 if it is equal and
+ * 1 + the index of the first cell that is greater than the best one
+ * otherwise.
+ */
+static int CanonicalSearch_compare( CanonicalSearch& cs, CanonicalCandidate& cc, int row, int r,
+		uint8_t *line ) {
+
+	const uint8_t *cells = &cs._cells[ cc._transpose ][ row * MAX_VAL ];
+	const int8_t *cols = column_permutations._cols[ cc._permutation ];
+	const uint8_t *best = &cs._best[ r * MAX_VAL ];
+
+	uint8_t labels[ DIM ];
+	memcpy( labels, cc._labels, DIM );
+	int next_label = cc._next_label;
+
+	int cmp = 0;
+
+	for (int c = 0; c < MAX_VAL; ++c) {
+
+		uint8_t v = cells[ cols[ c ] ];
+
+		if (v != ZERO) {
+			if (labels[ v ] == ZERO) labels[ v ] = next_label++;
+			v = labels[ v ];
+		}
+
+		line[ c ] = v;
+
+		if (cmp == 0) {
+			if (v > best[ c ]) return 1 + c;
+			if (v < best[ c ]) cmp = -1;
+		}
+	}
+
+	memcpy( cc._labels, labels, DIM );
+	cc._next_label = next_label;
+
+	return cmp;
+
+}
+
+/**
+ * Keep candidate cc for row r + 1 if its row 'line' is the best row
+ * r: the candidates kept before are removed if the row is smaller
+ * than the best one
+ */
+static void CanonicalSearch_keep( CanonicalSearch& cs, CanonicalCandidate& cc, int r, int cmp,
+		uint8_t *line ) {
+
+	vector< CanonicalCandidate >& kept = cs._candidates[ r + 1 ];
+
+	if (cmp < 0) {
+		// all the grids that start with this row are smaller
+		memcpy( &cs._best[ r * MAX_VAL ], line, MAX_VAL );
+		memset( &cs._best[ (r + 1) * MAX_VAL ], CANONICAL_INFINITY, (MAX_VAL - 1 - r) * MAX_VAL );
+		kept.clear();
+	}
+
+	kept.push_back( cc );
+
+}
+
+static void CanonicalSearch_rows( CanonicalSearch& cs, int r, int rows_used, int band );
+
+/**
+ * Go on with the rows below row r if some candidates give the best
+ * row r with 'row'
+ */
+static void CanonicalSearch_next( CanonicalSearch& cs, int r, int row, int rows_used ) {
+
+	if (cs._candidates[ r + 1 ].empty()) return;
+
+	cs._rows[ r ] = row;
+
+	if (r == MAX_VAL - 1) {
+		CanonicalSearch_record( cs, cs._candidates[ r + 1 ][ 0 ] );
+	} else {
+		CanonicalSearch_rows( cs, r + 1, rows_used | (1 << row), row / 3 );
+	}
+
+}
+
+/**
+ * Sort the numbers of givens of the rows of a grid like the rows of
+ * the canonical form: the rows of each band in increasing order (in
+ * 'bands'), then the bands in the lexicographic order of their rows
+ */
+static void CanonicalSearch_sort_counts( uint8_t *counts, uint8_t bands[ 3 ][ 3 ], uint8_t *sorted ) {
+
+	for (int b = 0; b < 3; ++b) {
+		std::copy( counts + 3 * b, counts + 3 * b + 3, bands[ b ] );
+		std::sort( bands[ b ], bands[ b ] + 3 );
+	}
+
+	int order[ 3 ] = { 0, 1, 2 };
+
+	std::sort( order, order + 3, [&bands]( int i, int j ) {
+		return std::lexicographical_compare( bands[ i ], bands[ i ] + 3, bands[ j ], bands[ j ] + 3 );
+	} );
+
+	for (int b = 0; b < 3; ++b) {
+		std::copy( bands[ order[ b ] ], bands[ order[ b ] ] + 3, sorted + 3 * b );
+	}
+
+}
+
+/**
+ * Find the candidates of the first row: the transpositions and the
+ * permutations of the columns whose numbers of givens of the rows
+ * then of the columns are the smallest. The columns are only fixed
+ * stack after stack: when the first columns don't have the numbers
+ * of givens wanted, all the permutations that start with the same
+ * stacks are skipped.
+ */
+static void CanonicalSearch_columns( CanonicalSearch& cs ) {
+
+	// numbers of givens of the rows sorted for each transposition,
+	// the columns of a grid are the rows of its transposition
+	uint8_t sorted[ 2 ][ MAX_VAL ];
+
+	for (int transpose = 0; transpose < 2; ++transpose) {
+		for (int row = 0; row < MAX_VAL; ++row) {
+			int n = 0;
+			for (int c = 0; c < MAX_VAL; ++c) {
+				if (cs._cells[ transpose ][ row * MAX_VAL + c ] != ZERO) ++n;
+			}
+			cs._counts[ transpose ][ row ] = static_cast<uint8_t>( n );
+		}
+		CanonicalSearch_sort_counts( cs._counts[ transpose ], cs._bands[ transpose ], sorted[ transpose ] );
+	}
+
+	int cmp = memcmp( sorted[ 0 ], sorted[ 1 ], MAX_VAL );
+	if (cmp == 0) cmp = memcmp( sorted[ 1 ], sorted[ 0 ], MAX_VAL );
+
+	memcpy( cs._target, sorted[ (cmp <= 0) ? 0 : 1 ], MAX_VAL );
+
+	cs._candidates[ 0 ].clear();
+
+	for (int transpose = 0; transpose < 2; ++transpose) {
+
+		if ((transpose == 0) ? (cmp > 0) : (cmp < 0)) continue;
+
+		// the columns of the grid are the rows of the other grid
+		uint8_t *counts = cs._counts[ 1 - transpose ];
+		uint8_t *target = sorted[ 1 - transpose ];
+
+		int p = 0;
+
+		while (p < NBR_COLUMN_PERMUTATIONS) {
+
+			const int8_t *cols = column_permutations._cols[ p ];
+
+			int c = 0;
+			while ((c < MAX_VAL) and (counts[ cols[ c ] ] == target[ c ])) ++c;
+
+			if (c < MAX_VAL) {
+				// skip the permutations with the same stacks up to
+				// the first column that is not wanted
+				int block = COLUMN_PERMUTATIONS_BLOCKS[ c / 3 ];
+				p = (p / block + 1) * block;
+				continue;
+			}
+
+			CanonicalCandidate cc;
+			cc._transpose = static_cast<uint8_t>( transpose );
+			cc._next_label = MIN_VAL;
+			cc._permutation = static_cast<uint16_t>( p );
+			memset( cc._labels, ZERO, DIM );
+
+			cs._candidates[ 0 ].push_back( cc );
+			++p;
+		}
+	}
+
+}
+
+/**
+ * Choose row r of the grid among the rows not used, the rows of a
+ * band are chosen before the rows of the next band, for the
+ * candidates that give the best rows above
+ */
+static void CanonicalSearch_rows( CanonicalSearch& cs, int r, int rows_used, int band ) {
+
+	int first, last;
+
+	if ((r % 3) == 0) {
+		// any row of a band that is not used
+		first = 0;
+		last = MAX_VAL;
+	} else {
+		first = 3 * band;
+		last = first + 3;
+	}
+
+	uint8_t line[ MAX_VAL ];
+
+	for (int row = first; row < last; ++row) {
+
+		if ((rows_used & (1 << row)) != 0) continue;
+		// a new band starts with a row of a band that is not used
+		if (((r % 3) == 0) and (((rows_used >> (3 * (row / 3))) & 7) != 0)) continue;
+
+		cs._candidates[ r + 1 ].clear();
+
+		// the candidates of row r are not changed by the rows below
+		for (CanonicalCandidate cc : cs._candidates[ r ]) {
+
+			// the row and its band must have the numbers of givens of
+			// the canonical form, so that the search can't stop at a
+			// row where no row of the band is left for a candidate
+			if (cs._counts[ cc._transpose ][ row ] != cs._target[ r ]) continue;
+			if (((r % 3) == 0) and (memcmp( cs._bands[ cc._transpose ][ row / 3 ],
+					&cs._target[ r ], 3 ) != 0)) continue;
+
+			int cmp = CanonicalSearch_compare( cs, cc, row, r, line );
+
+			if (cmp <= 0) CanonicalSearch_keep( cs, cc, r, cmp, line );
+		}
+
+		CanonicalSearch_next( cs, r, row, rows_used );
+	}
+
+}
+
+
+void Grid_canonical( Grid& g, Grid& canonical, GridTransform& t ) {
+
+	CanonicalSearch cs;
+
+	memset( cs._best, CANONICAL_INFINITY, GRID_NBR_CELLS );
+
+	for (int y = 0; y < MAX_VAL; ++y) {
+		for (int x = 0; x < MAX_VAL; ++x) {
+			cs._cells[ 0 ][ y * MAX_VAL + x ] = Grid_get( g, y + 1, x + 1 );
+			cs._cells[ 1 ][ y * MAX_VAL + x ] = Grid_get( g, x + 1, y + 1 );
+		}
+	}
+
+	CanonicalSearch_columns( cs );
+	CanonicalSearch_rows( cs, 0, 0, 0 );
+
+	t = cs._transform;
+
+	for (int y = 0; y < MAX_VAL; ++y) {
+		for (int x = 0; x < MAX_VAL; ++x) {
+			Grid_set( canonical, y + 1, x + 1, cs._best[ y * MAX_VAL + x ] );
+		}
+	}
+
+}
+
+
+uint64_t Grid_invariant( Grid& g ) {
+
+	uint8_t rows[ MAX_VAL ] = { 0 };
+	uint8_t cols[ MAX_VAL ] = { 0 };
+	uint8_t blks[ MAX_VAL ] = { 0 };
+	uint8_t digits[ DIM ] = { 0 };
+
+	for (int y = 0; y < MAX_VAL; ++y) {
+		for (int x = 0; x < MAX_VAL; ++x) {
+			GridElementType v = Grid_get( g, y + 1, x + 1 );
+			if (v == ZERO) continue;
+			++rows[ y ];
+			++cols[ x ];
+			++blks[ (y / 3) * 3 + x / 3 ];
+			++digits[ v ];
+		}
+	}
+
+	// numbers of givens sorted like the rows and the columns of the
+	// canonical form, the smallest first so that the transposition
+	// gives the same key
+	uint8_t key[ 4 * MAX_VAL ];
+	uint8_t bands[ 3 ][ 3 ];
+
+	CanonicalSearch_sort_counts( rows, bands, key );
+	CanonicalSearch_sort_counts( cols, bands, key + MAX_VAL );
+
+	if (memcmp( key, key + MAX_VAL, MAX_VAL ) > 0) {
+		std::swap_ranges( key, key + MAX_VAL, key + MAX_VAL );
+	}
+
+	std::sort( blks, blks + MAX_VAL );
+	std::sort( digits + MIN_VAL, digits + DIM );
+
+	memcpy( key + 2 * MAX_VAL, blks, MAX_VAL );
+	memcpy( key + 3 * MAX_VAL, digits + MIN_VAL, MAX_VAL );
+
+	// FNV-1a hash of the key
+	uint64_t h = 14695981039346656037ULL;
+
+	for (uint8_t b : key) {
+		h = (h ^ b) * 1099511628211ULL;
+	}
+
+	return h;
+
+}
+
+
+void Grid_transform( GridTransform& t, Grid& g, Grid& result ) {
+
+	for (int r = 0; r < MAX_VAL; ++r) {
+		for (int c = 0; c < MAX_VAL; ++c) {
+
+			int y = t._rows[ r ];
+			int x = t._cols[ c ];
+
+			if (t._transpose) std::swap( y, x );
+
+			Grid_set( result, r + 1, c + 1, t._labels[ Grid_get( g, y + 1, x + 1 ) ] );
+		}
+	}
+
+}
+
+
+void Grid_untransform( GridTransform& t, Grid& g, Grid& result ) {
+
+	int8_t digits[ DIM ];
+
+	for (int v = ZERO; v <= MAX_VAL; ++v) {
+		digits[ t._labels[ v ] ] = v;
+	}
+
+	for (int r = 0; r < MAX_VAL; ++r) {
+		for (int c = 0; c < MAX_VAL; ++c) {
+
+			int y = t._rows[ r ];
+			int x = t._cols[ c ];
+
+			if (t._transpose) std::swap( y, x );
+
+			Grid_set( result, y + 1, x + 1, digits[ Grid_get( g, r + 1, c + 1 ) ] );
+		}
+	}
+
+}
+
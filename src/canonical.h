@@ -0,0 +1,81 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include "grid.h"
+
+/**
+ * Canonical form of a grid under the symmetries of the Sudoku that
+ * keep the number of solutions:
+ * - transposition
+ * - permutation of the bands (groups of 3 rows) and of the rows of
+ *   a band
+ * - permutation of the stacks (groups of 3 columns) and of the
+ *   columns of a stack
+ * - relabeling of the digits
+ *
+ * The canonical form is the smallest grid (compared row after row,
+ * an empty cell being 0) among the transformations of the grid where
+ * the digits are relabeled in the order of their first appearance
+ * and where the numbers of givens of the rows, then of the columns,
+ * are the smallest: in each band (stack) the rows (columns) are
+ * sorted by their number of givens and the bands (stacks) by the
+ * numbers of givens of their rows (columns). These numbers are the
+ * same for all the transformations of a grid, so that two grids that
+ * are transformations of each other have the same canonical form,
+ * and they leave only a few permutations of the columns and of the
+ * rows to compare.
+ */
+
+/**
+ * Transformation from a grid to its canonical form: the cell (r, c)
+ * of the canonical form is the cell (_rows[ r ], _cols[ c ]) of the
+ * grid (transposed if _transpose is true) with the digit v replaced
+ * by _labels[ v ]. Indices start at 0.
+ */
+typedef struct GridTransform {
+	bool _transpose;
+	int8_t _rows[ MAX_VAL ];
+	int8_t _cols[ MAX_VAL ];
+	int8_t _labels[ DIM ];
+
+} GridTransform;
+
+/**
+ * Compute the canonical form of grid g and the transformation from
+ * g to its canonical form
+ */
+void Grid_canonical( Grid& g, Grid& canonical, GridTransform& t );
+
+/**
+ * Return a value that doesn't change with the transformations of
+ * grid g, computed from the numbers of givens of the rows, columns,
+ * bands, stacks, blocks and digits. Two grids with different values
+ * can't have the same canonical form and the value is much faster to
+ * get than the canonical form.
+ */
+uint64_t Grid_invariant( Grid& g );
+
+/**
+ * Apply transformation t to grid g, for example to get the solution
+ * of the canonical form from a solution of g
+ */
+void Grid_transform( GridTransform& t, Grid& g, Grid& result );
+
+/**
+ * Apply the inverse of transformation t to grid g, for example to
+ * get a solution of the initial grid from a solution of its
+ * canonical form
+ */
+void Grid_untransform( GridTransform& t, Grid& g, Grid& result );
+
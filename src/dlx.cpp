@@ -0,0 +1,239 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include "dlx.h"
+#include "grid_tables.h"
+
+/**
+ * Encode candidate (y, x, v) as an integer between 0 and 728
+ */
+static inline int DLX_candidate( int y, int x, int v ) {
+	return ((y - 1) * 9 + (x - 1)) * 9 + (v - 1);
+}
+
+/**
+ * Remove column c from the header list and all the rows that
+ * have a node in column c from the other columns
+ */
+static inline void DLX_cover( DLX& d, int c ) {
+
+	d._L[ d._R[ c ] ] = d._L[ c ];
+	d._R[ d._L[ c ] ] = d._R[ c ];
+
+	for (int i = d._D[ c ]; i != c; i = d._D[ i ]) {
+		for (int j = d._R[ i ]; j != i; j = d._R[ j ]) {
+			d._U[ d._D[ j ] ] = d._U[ j ];
+			d._D[ d._U[ j ] ] = d._D[ j ];
+			--d._S[ d._C[ j ] ];
+		}
+	}
+
+}
+
+/**
+ * Restore column c, the links are restored in the reverse order
+ * of DLX_cover()
+ */
+static inline void DLX_uncover( DLX& d, int c ) {
+
+	for (int i = d._U[ c ]; i != c; i = d._U[ i ]) {
+		for (int j = d._L[ i ]; j != i; j = d._L[ j ]) {
+			++d._S[ d._C[ j ] ];
+			d._U[ d._D[ j ] ] = j;
+			d._D[ d._U[ j ] ] = j;
+		}
+	}
+
+	d._L[ d._R[ c ] ] = c;
+	d._R[ d._L[ c ] ] = c;
+
+}
+
+/**
+ * Add node to column c and return its index
+ */
+static inline int DLX_add_node( DLX& d, int c, int candidate ) {
+
+	int n = d._nbr_nodes++;
+
+	d._C[ n ] = c;
+	d._candidate[ n ] = candidate;
+
+	// insert at the bottom of the column
+	d._U[ n ] = d._U[ c ];
+	d._D[ n ] = c;
+	d._D[ d._U[ c ] ] = n;
+	d._U[ c ] = n;
+	++d._S[ c ];
+
+	return n;
+}
+
+
+bool DLX_init( DLX& d, Grid& g ) {
+
+	Grid_copy( d._grid, g );
+	d._nbr_solutions = 0;
+	d._callback = nullptr;
+	d._data = nullptr;
+
+	// root and column headers
+	for (int c = 0; c <= DLX_NBR_COLUMNS; ++c) {
+		d._L[ c ] = (c == 0) ? DLX_NBR_COLUMNS : c - 1;
+		d._R[ c ] = (c == DLX_NBR_COLUMNS) ? 0 : c + 1;
+		d._U[ c ] = d._D[ c ] = c;
+		d._C[ c ] = c;
+		d._candidate[ c ] = -1;
+		d._S[ c ] = 0;
+	}
+	d._nbr_nodes = DLX_NBR_COLUMNS + 1;
+
+	// first node of each candidate
+	int first_node[ DLX_NBR_CANDIDATES ];
+
+	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
+		for (int x = MIN_VAL; x <= MAX_VAL; ++x) {
+
+			int b = grid_tables._blk[ Grid_cell_of( y, x ) ] - 1;
+
+			for (int v = MIN_VAL; v <= MAX_VAL; ++v) {
+
+				int candidate = DLX_candidate( y, x, v );
+				int columns[ 4 ] = {
+					1 + (y - 1) * 9 + (x - 1),
+					1 + 81 + (y - 1) * 9 + (v - 1),
+					1 + 162 + (x - 1) * 9 + (v - 1),
+					1 + 243 + b * 9 + (v - 1)
+				};
+
+				int first = 0;
+				for (int k = 0; k < 4; ++k) {
+					int n = DLX_add_node( d, columns[ k ], candidate );
+					if (k == 0) {
+						first = n;
+						d._L[ n ] = d._R[ n ] = n;
+					} else {
+						d._R[ n ] = first;
+						d._L[ n ] = d._L[ first ];
+						d._R[ d._L[ first ] ] = n;
+						d._L[ first ] = n;
+					}
+				}
+
+				first_node[ candidate ] = first;
+			}
+		}
+	}
+
+	// select the candidates of the values already set
+	bool covered[ DLX_NBR_COLUMNS + 1 ];
+	memset( covered, 0, sizeof( covered ) );
+
+	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
+		for (int x = MIN_VAL; x <= MAX_VAL; ++x) {
+
+			GridElementType v = Grid_get( g, y, x );
+
+			if (v == ZERO) continue;
+
+			int r = first_node[ DLX_candidate( y, x, v ) ];
+			int j = r;
+			do {
+				if (covered[ d._C[ j ] ]) return false;
+				covered[ d._C[ j ] ] = true;
+				DLX_cover( d, d._C[ j ] );
+				j = d._R[ j ];
+			} while (j != r);
+		}
+	}
+
+	return true;
+
+}
+
+/**
+ * Algorithm X: select the column with the minimum number of nodes
+ * and try each row of this column
+ */
+static void DLX_search( DLX& d, int k ) {
+
+	if (d._R[ 0 ] == 0) {
+
+		++d._nbr_solutions;
+
+		if (d._callback != nullptr) {
+			Grid solution;
+			Grid_copy( solution, d._grid );
+			for (int i = 0; i < k; ++i) {
+				int candidate = d._selected[ i ];
+				int cell = candidate / 9;
+				Grid_set( solution, cell / 9 + 1, cell % 9 + 1, candidate % 9 + 1 );
+			}
+			d._callback( solution, d._data );
+		}
+
+		return;
+	}
+
+	int c = d._R[ 0 ];
+	for (int j = d._R[ c ]; j != 0; j = d._R[ j ]) {
+		if (d._S[ j ] < d._S[ c ]) c = j;
+	}
+
+	if (d._S[ c ] == 0) return;
+
+	DLX_cover( d, c );
+
+	for (int r = d._D[ c ]; r != c; r = d._D[ r ]) {
+
+		d._selected[ k ] = d._candidate[ r ];
+
+		for (int j = d._R[ r ]; j != r; j = d._R[ j ]) {
+			DLX_cover( d, d._C[ j ] );
+		}
+
+		DLX_search( d, k + 1 );
+
+		for (int j = d._L[ r ]; j != r; j = d._L[ j ]) {
+			DLX_uncover( d, d._C[ j ] );
+		}
+
+		if ((d._max_solutions != 0) and (d._nbr_solutions == d._max_solutions)) {
+			if (d._D[ r ] != c) d._stopped = true;
+			break;
+		}
+
+	}
+
+	DLX_uncover( d, c );
+
+}
+
+
+int DLX_solve( DLX& d, DLX_SolutionCallback callback, void *data,
+		int max_solutions ) {
+
+	d._nbr_solutions = 0;
+	d._max_solutions = max_solutions;
+	d._stopped = false;
+	d._callback = callback;
+	d._data = data;
+
+	DLX_search( d, 0 );
+
+	return d._nbr_solutions;
+
+}
@@ -0,0 +1,92 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include "grid.h"
+
+/**
+ * Resolution of the Sudoku as an exact cover problem with the
+ * Dancing Links of D. Knuth (Algorithm X).
+ *
+ * The matrix has 324 columns (constraints):
+ * - 81 columns: cell (y,x) contains a value
+ * - 81 columns: row y contains value v
+ * - 81 columns: column x contains value v
+ * - 81 columns: block b contains value v
+ *
+ * and 729 rows (candidates), a row being the placement of value v
+ * in cell (y,x) which covers exactly 4 columns.
+ */
+
+const int DLX_NBR_COLUMNS    = 4 * 81;
+const int DLX_NBR_CANDIDATES = 9 * 81;
+const int DLX_NBR_NODES      = 1 + DLX_NBR_COLUMNS + 4 * DLX_NBR_CANDIDATES;
+
+/**
+ * Function called for each solution found
+ */
+typedef void (*DLX_SolutionCallback)( Grid& solution, void *data );
+
+/**
+ * Structure of the Dancing Links: nodes are stored in arrays and
+ * linked by their index. Node 0 is the root, nodes 1 to 324 are the
+ * headers of the columns.
+ */
+typedef struct DLX {
+
+	// links left, right, up, down
+	int _L[ DLX_NBR_NODES ];
+	int _R[ DLX_NBR_NODES ];
+	int _U[ DLX_NBR_NODES ];
+	int _D[ DLX_NBR_NODES ];
+	// column header of the node
+	int _C[ DLX_NBR_NODES ];
+	// candidate (y, x, v) of the node encoded as an integer
+	int _candidate[ DLX_NBR_NODES ];
+	// number of nodes in each column
+	int _S[ DLX_NBR_COLUMNS + 1 ];
+	int _nbr_nodes;
+
+	// candidates selected by the search, from depth 0 to 80
+	int _selected[ 81 ];
+	// values of the initial grid
+	Grid _grid;
+
+	int _nbr_solutions;
+	// the search stops when this number of solutions is found,
+	// 0 to find all solutions
+	int _max_solutions;
+	// true if the search stopped before all rows were tried
+	bool _stopped;
+	DLX_SolutionCallback _callback;
+	void *_data;
+
+} DLX;
+
+/**
+ * Build the exact cover matrix for the given grid and cover the
+ * columns of the values already set.
+ *
+ * Return false if the values of the grid violate the alldiff
+ * constraints, in which case the grid has no solution.
+ */
+bool DLX_init( DLX& d, Grid& g );
+
+/**
+ * Enumerate all solutions, or the first 'max_solutions' solutions if
+ * it is not 0, and return their number. If the callback is not null
+ * it is called with each solution.
+ */
+int DLX_solve( DLX& d, DLX_SolutionCallback callback = nullptr, void *data = nullptr,
+	int max_solutions = 0 );
+
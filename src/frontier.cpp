@@ -0,0 +1,86 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include <algorithm>
+#include "frontier.h"
+
+void Frontier_expand( Frontier& f, Grid& g, size_t nbr_nodes, bool reverse ) {
+
+	// same order as the sequential search
+	vector< PositionCost > epc;
+	Grid_find_empty_positions_costs( g, epc );
+
+	std::sort( epc.begin(), epc.end(), []( const PositionCost& a, const PositionCost& b) {
+		return a._cost > b._cost;
+	} );
+
+	if (reverse) {
+		std::reverse( epc.begin(), epc.end() );
+	}
+
+	f._positions.clear();
+	for (PositionCost& pc : epc) {
+		Position p;
+		p._y = pc._y;
+		p._x = pc._x;
+		f._positions.push_back( p );
+	}
+
+	f._depth = 0;
+	f._grids.clear();
+
+	GridState state;
+
+	if (GridState_init( state, g ) == UNSATISFIED) return;
+
+	f._grids.push_back( g );
+
+	int last = static_cast<int>( f._positions.size() ) - 1;
+
+	vector< Grid > level;
+
+	while ((f._grids.size() < nbr_nodes) and (f._depth < last) and !f._grids.empty()) {
+
+		Position& p = f._positions[ f._depth ];
+		int b = Grid_block_of( p._y, p._x );
+
+		level.clear();
+
+		for (Grid& node : f._grids) {
+
+			GridState_init( state, node );
+
+			for (GridElementType v = MIN_VAL; v <= MAX_VAL; ++v) {
+				if (GridState_can_place( state, p._y, p._x, b, v )) {
+					level.push_back( node );
+					Grid_set( level.back(), p._y, p._x, v );
+				}
+			}
+		}
+
+		f._grids.swap( level );
+		++f._depth;
+	}
+
+}
+
+
+void Frontier_empty_positions( Frontier& f, vector< Position >& positions ) {
+
+	positions.assign( f._positions.begin() + f._depth, f._positions.end() );
+
+}
+
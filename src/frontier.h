@@ -0,0 +1,55 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <vector>
+#include "grid.h"
+#include "grid_state.h"
+
+/**
+ * Frontier of the search tree of a grid, an alternative to the seed
+ * grids given by the permutations of whole blocks.
+ *
+ * The tree is expanded breadth first, one empty cell at each level,
+ * in the order of the sequential search: from the most constrained
+ * cell to the least constrained. A node is only kept if its value
+ * doesn't violate the constraints, so all the grids of the frontier
+ * are consistent and they all have the same empty cells. The
+ * expansion stops at the first level that has enough nodes, the
+ * grids of this level are the tasks of the parallel searches.
+ */
+typedef struct Frontier {
+	// empty cells of the initial grid in the order of the search,
+	// the first _depth cells are filled in the grids of the frontier
+	std::vector< Position > _positions;
+	int _depth;
+	// grids of the frontier
+	std::vector< Grid > _grids;
+
+} Frontier;
+
+/**
+ * Expand the search tree of grid g until the frontier has at least
+ * nbr_nodes grids, or until only one empty cell is left in the grids.
+ * The order of the cells is reversed if reverse is true. The frontier
+ * is empty if the grid violates the constraints or has no solution
+ * at the depth reached.
+ */
+void Frontier_expand( Frontier& f, Grid& g, size_t nbr_nodes, bool reverse = false );
+
+/**
+ * Find positions that remain empty in the grids of the frontier, in
+ * the order of the search
+ */
+void Frontier_empty_positions( Frontier& f, std::vector< Position >& positions );
+
@@ -1,5 +1,21 @@
 #include "gpu_grid.h"
 
+// block of each cell and cells of each block, see grid_tables.h
+__constant__ uint8_t gpu_grid_blk[ GRID_NBR_CELLS ];
+__constant__ uint8_t gpu_grid_blk_cells[ DIM ][ MAX_VAL ];
+
+
+cudaError_t GPU_Grid_init_tables() {
+
+	cudaError_t err = cudaMemcpyToSymbol( gpu_grid_blk, grid_tables._blk, sizeof( grid_tables._blk ) );
+	
+	if (err != cudaSuccess) return err;
+	
+	return cudaMemcpyToSymbol( gpu_grid_blk_cells, grid_tables._blk_cells, sizeof( grid_tables._blk_cells ) );
+
+}
+
+
 __device__ 
 int GPU_Grid_row_satisfied( Grid& g, int y ) {
 	
@@ -11,7 +27,7 @@ int GPU_Grid_row_satisfied( Grid& g, int y ) {
 
 	for (int x = MIN_VAL; x <= MAX_VAL; ++x) {
 	
-		GridElementType v = g[ y ][ x ];
+		GridElementType v = Grid_get( g, y, x );
 		 
 		if (v == ZERO) continue;
 		
@@ -39,7 +55,7 @@ int GPU_Grid_col_satisfied( Grid& g, int x ) {
 	
 	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
 		
-		GridElementType v = g[ y ][ x ];	
+		GridElementType v = Grid_get( g, y, x );	
 		
 		if (v == ZERO) continue;
 		
@@ -58,30 +74,24 @@ int GPU_Grid_col_satisfied( Grid& g, int x ) {
 __device__ 
 int GPU_Grid_blk_satisfied( Grid& g, int b ) {
 
-	int y = ((b - 1) / 3) * 3 + 1;
-	int x = ((b - 1) % 3) * 3 + 1;
-	
-	
 	// store values found as powers of 2
 	// this represents the alldiff constraint
 	int values = 0;
 
 	int product = 1;	
 	
-	for (int r = 0; r < 3; ++r) {
-		for (int s = 0; s < 3; ++s) {
+	for (int k = 0; k < MAX_VAL; ++k) {
 		
-			GridElementType v = g[ y + r ][ x + s ];	
-			
-			if (v == ZERO) continue;
-			
-			if ((values & (1 << v)) != 0) {
-				return UNSATISFIED;
-			}
-			
-			product *= v;
-			values |= (1 << v);
+		GridElementType v = Grid_get_cell( g, gpu_grid_blk_cells[ b ][ k ] );	
+		
+		if (v == ZERO) continue;
+		
+		if ((values & (1 << v)) != 0) {
+			return UNSATISFIED;
 		}
+		
+		product *= v;
+		values |= (1 << v);
 	}
 	
 	return (product == FACTORIAL_9) ? SATISFIED : ALMOST; 
@@ -125,3 +135,86 @@ int GPU_Grid_satisfied( Grid& g ) {
 }
 
 
+__device__
+int GPU_GridState_init( GridState& s, Grid& g ) {
+
+	for (int i = 0; i < DIM; ++i) {
+		s._rows[ i ] = s._cols[ i ] = s._blks[ i ] = 0;
+	}
+	s._empty[ 0 ] = ~static_cast<uint64_t>( 0 );
+	s._empty[ 1 ] = (static_cast<uint64_t>( 1 ) << (81 - 64)) - 1;
+	
+	int nbr_set = 0;
+	
+	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
+		for (int x = MIN_VAL; x <= MAX_VAL; ++x) {
+		
+			GridElementType v = Grid_get( g, y, x );
+			
+			if (v == ZERO) continue;
+			
+			int b = gpu_grid_blk[ Grid_cell_of( y, x ) ];
+			
+			if (!GPU_GridState_can_place( s, y, x, b, v )) {
+				return UNSATISFIED;
+			}
+			
+			GPU_GridState_place( s, y, x, b, v );
+			++nbr_set;
+		}
+	}
+	
+	return (nbr_set == MAX_VAL * MAX_VAL) ? SATISFIED : ALMOST;
+	
+}
+
+
+__device__
+bool GPU_GridState_can_place( GridState& s, int y, int x, int b, GridElementType v ) {
+
+	GridMask m = static_cast<GridMask>( 1 << v );
+	return ((s._rows[ y ] | s._cols[ x ] | s._blks[ b ]) & m) == 0;
+	
+}
+
+
+__device__
+void GPU_GridState_place( GridState& s, int y, int x, int b, GridElementType v ) {
+
+	GridMask m = static_cast<GridMask>( 1 << v );
+	s._rows[ y ] |= m;
+	s._cols[ x ] |= m;
+	s._blks[ b ] |= m;
+	
+	int c = (y - 1) * 9 + (x - 1);
+	s._empty[ c >> 6 ] &= ~(static_cast<uint64_t>( 1 ) << (c & 63));
+	
+}
+
+
+__device__
+void GPU_GridState_remove( GridState& s, int y, int x, int b, GridElementType v ) {
+
+	GridMask m = static_cast<GridMask>( ~(1 << v) );
+	s._rows[ y ] &= m;
+	s._cols[ x ] &= m;
+	s._blks[ b ] &= m;
+	
+	int c = (y - 1) * 9 + (x - 1);
+	s._empty[ c >> 6 ] |= static_cast<uint64_t>( 1 ) << (c & 63);
+	
+}
+
+
+__device__
+int GPU_GridState_satisfied( GridState& s ) {
+
+	GridMask m = FULL_MASK;
+	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
+		m &= s._rows[ y ];
+	}
+	
+	return (m == FULL_MASK) ? SATISFIED : ALMOST;
+	
+}
+
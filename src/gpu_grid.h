@@ -1,5 +1,15 @@
 #pragma once
 #include "grid.h"
+#include "grid_state.h"
+#include "grid_tables.h"
+
+/**
+ * Copy the block of each cell and the cells of each block (see
+ * grid_tables.h) to the constant memory of the GPU so that the
+ * threads don't divide the coordinates. Must be called before the
+ * kernels are launched.
+ */
+cudaError_t GPU_Grid_init_tables();
 
 
 __device__ 
@@ -52,3 +62,43 @@ int GPU_Grid_blk_satisfied( Grid& g, int b );
 __device__ 
 int GPU_Grid_satisfied( Grid& g );
 
+/**
+ * Initialize the state of the constraints from the values of the grid.
+ *
+ * This function returns:
+ * - UNSATISFIED if a value appears twice in a row, column or block
+ * - SATISFIED if all cells are set
+ * - ALMOST otherwise
+ */
+
+__device__
+int GPU_GridState_init( GridState& s, Grid& g );
+
+/**
+ * Return true if value v can be placed in cell (y,x) of block b
+ */
+
+__device__
+bool GPU_GridState_can_place( GridState& s, int y, int x, int b, GridElementType v );
+
+/**
+ * Record that value v is placed in cell (y,x) of block b
+ */
+
+__device__
+void GPU_GridState_place( GridState& s, int y, int x, int b, GridElementType v );
+
+/**
+ * Record that value v is removed from cell (y,x) of block b
+ */
+
+__device__
+void GPU_GridState_remove( GridState& s, int y, int x, int b, GridElementType v );
+
+/**
+ * SATISFIED if all rows of the state are full, ALMOST otherwise
+ */
+
+__device__
+int GPU_GridState_satisfied( GridState& s );
+
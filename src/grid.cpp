@@ -1,4 +1,8 @@
 #include "grid.h"
+#include "grid_tables.h"
+
+// computed by the compiler, see GridTables_make()
+constexpr GridTables grid_tables = GridTables_make();
 
 void Grid_init( Grid& g ) {
 
@@ -10,23 +14,110 @@ void Grid_init( Grid& g ) {
 
 void Grid_fill( Grid& g, string s ) {
 
-	istringstream ifs( s );
+	Grid_parse( g, s.data(), s.data() + s.size() );
 	
+}
+
+
+const char *Grid_parse( Grid& g, const char *p, const char *end ) {
+
 	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
 		for (int x = MIN_VAL; x <= MAX_VAL; ++x) {
-	
-			GridElementType v;
+		
+			// skip separators
+			while ((p < end) and (static_cast<unsigned char>( *p - '0' ) > 9) and (*p != '.')) {
+				++p;
+			}
 			
-			ifs >> v;
+			if (p == end) return nullptr;
 			
-			g[ y ][ x ] = v;
+			Grid_set( g, y, x, (*p == '.') ? ZERO : *p - '0' );
+			++p;
 			
 		}
-	} 
+	}
+	
+	return p;
+	
+}
+
+
+bool Grid_read( istream& in, Grid& g ) {
+
+	Grid_init( g );
+	
+	int count = 0;
+	string line;
+	
+	while ((count < MAX_VAL * MAX_VAL) and getline( in, line )) {
+	
+		for (char c : line) {
+		
+			if (('0' <= c) and (c <= '9')) {
+				Grid_set_cell( g, count, c - '0' );
+			} else if (c == '.') {
+				Grid_set_cell( g, count, ZERO );
+			} else {
+				continue;
+			}
+			
+			if (++count == MAX_VAL * MAX_VAL) break;
+		}
+		
+	}
+	
+	return count == MAX_VAL * MAX_VAL;
+	
+}
+
+
+string Grid_to_string( Grid& g ) {
+
+	string s( MAX_VAL * MAX_VAL, '.' );
+	
+	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
+		for (int x = MIN_VAL; x <= MAX_VAL; ++x) {
+		
+			GridElementType v = Grid_get( g, y, x );
+			
+			if (v != ZERO) {
+				s[ (y - 1) * MAX_VAL + (x - 1) ] = static_cast<char>( '0' + v );
+			}
+		}
+	}
+	
+	return s;
 	
 }
 
 
+void Grid_pack( Grid& g, uint8_t *bytes ) {
+
+#if GRID_CELL_BITS == 4
+	memcpy( bytes, g._cells, GRID_PACKED_SIZE );
+#else
+	for (int i = 0; i < GRID_NBR_CELLS / 2; ++i) {
+		bytes[ i ] = static_cast<uint8_t>( g._cells[ 2 * i ] | (g._cells[ 2 * i + 1 ] << 4) );
+	}
+	bytes[ GRID_PACKED_SIZE - 1 ] = static_cast<uint8_t>( g._cells[ GRID_NBR_CELLS - 1 ] );
+#endif
+
+}
+
+
+void Grid_unpack( Grid& g, const uint8_t *bytes ) {
+
+#if GRID_CELL_BITS == 4
+	memcpy( g._cells, bytes, GRID_PACKED_SIZE );
+#else
+	for (int c = 0; c < GRID_NBR_CELLS; ++c) {
+		g._cells[ c ] = (bytes[ c >> 1 ] >> ((c & 1) << 2)) & 0xF;
+	}
+#endif
+
+}
+
+
 void Grid_copy( Grid& dst, Grid& src ) {
 	
 	memcpy( &dst, &src, sizeof( Grid ) );
@@ -41,7 +132,7 @@ ostream& Grid_print( ostream& out, Grid& g ) {
 	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
 		out << y << "| ";
 		for (int x = MIN_VAL; x <= MAX_VAL; ++x) {
-			out << g[ y ][ x ] << " ";
+			out << static_cast<int>( Grid_get( g, y, x ) ) << " ";
 			if ((x % 3) == 0) out << "|";
 		}
 		out << endl;
@@ -69,7 +160,7 @@ int Grid_row_satisfied( Grid& g, int y ) {
 	
 	for (int x = MIN_VAL; x <= MAX_VAL; ++x) {
 	
-		GridElementType v = g[ y ][ x ];
+		GridElementType v = Grid_get( g, y, x );
 
 		//printf("product=%d, value=%d\n", product, v );
 		
@@ -99,7 +190,7 @@ int Grid_col_satisfied( Grid& g, int x ) {
 	
 	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
 		
-		GridElementType v = g[ y ][ x ];	
+		GridElementType v = Grid_get( g, y, x );	
 		
 		if (v == ZERO) continue;
 		
@@ -116,40 +207,37 @@ int Grid_col_satisfied( Grid& g, int x ) {
 
 int Grid_blk_satisfied( Grid& g, int b ) {
 
-	int y = ((b - 1) / 3) * 3 + 1;
-	int x = ((b - 1) % 3) * 3 + 1;
-	
 #ifdef DEBUG	
-	assert( (MIN_VAL <= x) and (x <= MAX_VAL) );
+	assert( (MIN_VAL <= b) and (b <= MAX_VAL) );
 #endif
 	
+	const uint8_t *cells = grid_tables._blk_cells[ b ];
+	
 	// store values found as powers of 2
 	// this represents the alldiff constraint
 	int values = 0;
 
 	int product = 1;	
 	
-	for (int r = 0; r < 3; ++r) {
-		for (int s = 0; s < 3; ++s) {
+	for (int k = 0; k < MAX_VAL; ++k) {
 		
-			GridElementType v = g[ y + r ][ x + s ];
-			
-			if (v == ZERO) continue;
-			
-			if ((values & (1 << v)) != 0) {
-				return UNSATISFIED;
-			}
-			
-			product *= v;
-			values |= (1 << v);
+		GridElementType v = Grid_get_cell( g, cells[ k ] );
+		
+		if (v == ZERO) continue;
+		
+		if ((values & (1 << v)) != 0) {
+			return UNSATISFIED;
 		}
+		
+		product *= v;
+		values |= (1 << v);
 	}
 	
 	return (product == FACTORIAL_9) ? SATISFIED : ALMOST; 
 }
 
 
-int Grid_satisfied( Grid& g ) {
+int Grid_satisfied_scalar( Grid& g ) {
 
 	// by default we consider the problem as SATISFIED
 	int satisfiability = SATISFIED;
@@ -191,7 +279,7 @@ void Grid_find_empty_positions( Grid& g, vector<Position>& positions ) {
 	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
 		for (int x = MIN_VAL; x <= MAX_VAL; ++x) {
 		
-			GridElementType v = g[ y ][ x ];
+			GridElementType v = Grid_get( g, y, x );
 					
 			if ( v == ZERO ) {
 
@@ -210,21 +298,13 @@ void Grid_find_empty_positions( Grid& g, vector<Position>& positions ) {
 
 int Grid_position_nbr_values_set( Grid& g, Position& p ) {
 
-	int block = ((p._y-1) / 3) * 3 + ((p._x-1) / 3) + 1;
-	
-	int y = ((block - 1) / 3) * 3 + 1;
-	int x = ((block - 1) % 3) * 3 + 1;
+	int block = grid_tables._blk[ Grid_cell_of( p._y, p._x ) ];
+	const uint8_t *cells = grid_tables._blk_cells[ block ];
 	
 	int count = 0;
 	
-	for (int r = 0; r < 3; ++r) {
-		for (int s = 0; s < 3; ++s) {
-		
-			GridElementType v = g[ y + r ][  x + s ];
-			
-			if (v != ZERO) ++count;
-			
-		}
+	for (int k = 0; k < MAX_VAL; ++k) {
+		if (Grid_get_cell( g, cells[ k ] ) != ZERO) ++count;
 	}
 	
 	return count;
@@ -232,21 +312,18 @@ int Grid_position_nbr_values_set( Grid& g, Position& p ) {
 
 int Grid_block_nbr_values_set( Grid& g, int block, vector<int>& missing_values ) {
 
-	int y = ((block - 1) / 3) * 3 + 1;
-	int x = ((block - 1) % 3) * 3 + 1;
+	const uint8_t *cells = grid_tables._blk_cells[ block ];
 	
 	int count = 0;
 	int values = 0;
 	
-	for (int r = 0; r < 3; ++r) {
-		for (int s = 0; s < 3; ++s) {
+	for (int k = 0; k < MAX_VAL; ++k) {
 		
-			GridElementType v = g[ y + r ][ x + s ];
-			
-			if (v != ZERO) {
-				++count;
-				values |= (1 << v);
-			}
+		GridElementType v = Grid_get_cell( g, cells[ k ] );
+		
+		if (v != ZERO) {
+			++count;
+			values |= (1 << v);
 		}
 	}
 	
@@ -269,7 +346,7 @@ void Grid_find_empty_positions_costs( Grid& g, vector<PositionCost>& positions_c
 	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
 		for (int x = MIN_VAL; x <= MAX_VAL; ++x) {
 		
-			GridElementType v = g[ y ][ x ];
+			GridElementType v = Grid_get( g, y, x );
 					
 			if ( v == ZERO ) {
 
@@ -288,24 +365,19 @@ void Grid_find_empty_positions_costs( Grid& g, vector<PositionCost>& positions_c
 
 void Grid_fill_block( Grid& g, int block, vector<int>& values ) {
 	
-	int y = ((block - 1) / 3) * 3 + 1;
-	int x = ((block - 1) % 3) * 3 + 1;
+	const uint8_t *cells = grid_tables._blk_cells[ block ];
 	
 	int k = 0;
 	
-	for (int r = 0; r < 3; ++r) {
-		for (int s = 0; s < 3; ++s) {
+	for (int i = 0; i < MAX_VAL; ++i) {
 	
-			int grid_value = g[ y + r ][ x + s ];
-			
-			if (grid_value == ZERO) { 
-			
-				g[ y + r ][ x + s ] = values[ k ];
-				++k;
-				
-			}	
+		if (Grid_get_cell( g, cells[ i ] ) == ZERO) { 
 		
-		}
+			Grid_set_cell( g, cells[ i ], values[ k ] );
+			++k;
+			
+		}	
+	
 	} 
 	
 }
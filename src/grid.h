@@ -30,17 +30,95 @@ const int MAX_VAL = 9;
 const int ZERO = 0;
 
 
+// Number of cells of a grid
+const int GRID_NBR_CELLS = MAX_VAL * MAX_VAL;
+
+/**
+ * Number of bits used to store a cell of the grid: 4, 8, 16 or 32.
+ * With 4 bits two cells are packed in a byte and a grid is stored
+ * in 41 bytes, with 8 bits a grid is stored in 81 bytes. It can be
+ * changed at compile time with -DGRID_CELL_BITS=n
+ */
+#ifndef GRID_CELL_BITS
+#define GRID_CELL_BITS 8
+#endif
+
 /**
  * Type of an element of the grid: use a 8, 16 or 32 integer
  * or unsigned integer
  */
+#if GRID_CELL_BITS == 32
 typedef int32_t GridElementType;
+#elif GRID_CELL_BITS == 16
+typedef int16_t GridElementType;
+#elif (GRID_CELL_BITS == 8) or (GRID_CELL_BITS == 4)
+typedef int8_t GridElementType;
+#else
+#error "GRID_CELL_BITS must be 4, 8, 16 or 32"
+#endif
+
+/**
+ * Definition of a grid which stores the 81 cells row after row.
+ * The cells must be accessed with Grid_get() and Grid_set() which
+ * use the coordinates of the cells in the range [1..9].
+ */
+typedef struct Grid {
+#if GRID_CELL_BITS == 4
+	uint8_t _cells[ (GRID_NBR_CELLS + 1) / 2 ];
+#else
+	GridElementType _cells[ GRID_NBR_CELLS ];
+#endif
+
+} Grid;
+
+// the accessors are also used by the GPU kernels
+#ifdef __CUDACC__
+#define GRID_FUNCTION __host__ __device__ inline
+#else
+#define GRID_FUNCTION inline
+#endif
+
+/**
+ * Return value of cell c = (y-1)*9 + (x-1)
+ */
+GRID_FUNCTION GridElementType Grid_get_cell( const Grid& g, int c ) {
+
+#if GRID_CELL_BITS == 4
+	return (g._cells[ c >> 1 ] >> ((c & 1) << 2)) & 0xF;
+#else
+	return g._cells[ c ];
+#endif
+
+}
+
+/**
+ * Set value of cell c = (y-1)*9 + (x-1)
+ */
+GRID_FUNCTION void Grid_set_cell( Grid& g, int c, GridElementType v ) {
+
+#if GRID_CELL_BITS == 4
+	int shift = (c & 1) << 2;
+	uint8_t& cells = g._cells[ c >> 1 ];
+	cells = (cells & ~(0xF << shift)) | (v << shift);
+#else
+	g._cells[ c ] = v;
+#endif
+
+}
+
+/**
+ * Return value of cell (y,x)
+ */
+GRID_FUNCTION GridElementType Grid_get( const Grid& g, int y, int x ) {
+	return Grid_get_cell( g, (y - 1) * MAX_VAL + (x - 1) );
+}
 
 /**
- * Definition of a grid which is a square matrix of size DIM.
- * Note that row 0 and column 0 are not used.
+ * Set value of cell (y,x)
  */
-typedef GridElementType Grid[ DIM ][ DIM ];
+GRID_FUNCTION void Grid_set( Grid& g, int y, int x, GridElementType v ) {
+	Grid_set_cell( g, (y - 1) * MAX_VAL + (x - 1), v );
+}
 
 /**
  * Initialize a grid and fill all elements with 0
@@ -53,6 +131,49 @@ void Grid_init( Grid& g );
  */
 void Grid_fill( Grid& g, string s );
 
+/**
+ * Parse the 81 values of a grid from the characters between p and
+ * end, with the same format as Grid_read(). Return a pointer to the
+ * character after the last value or nullptr if there are less than
+ * 81 values.
+ */
+const char *Grid_parse( Grid& g, const char *p, const char *end );
+
+/**
+ * Read next grid from input stream. Two formats are accepted:
+ * - 81 characters on one line
+ * - 9 lines of 9 values separated by spaces (see Grid_fill)
+ *
+ * Digits are the values of the cells, a '0' or a '.' is an empty 
+ * cell and other characters are ignored. When 81 cells are read the
+ * rest of the line is skipped.
+ *
+ * Return false if the end of the stream is reached before 81 cells
+ * could be read.
+ */
+bool Grid_read( istream& in, Grid& g );
+
+/**
+ * Return the values of the grid as a string of 81 characters
+ * where an empty cell is represented by a '.'
+ */
+string Grid_to_string( Grid& g );
+
+// number of bytes of a grid packed with two cells per byte
+const int GRID_PACKED_SIZE = (GRID_NBR_CELLS + 1) / 2;
+
+/**
+ * Store the values of the grid in GRID_PACKED_SIZE bytes: cell c
+ * is in byte c / 2, in the low 4 bits if c is even and in the high
+ * 4 bits otherwise (the layout of a grid with GRID_CELL_BITS=4)
+ */
+void Grid_pack( Grid& g, uint8_t *bytes );
+
+/**
+ * Set the values of the grid from bytes written by Grid_pack()
+ */
+void Grid_unpack( Grid& g, const uint8_t *bytes );
+
 /**
  * Copy contents of source grid to destination grid
  *
@@ -144,10 +265,18 @@ int Grid_blk_satisfied( Grid& g, int b );
  * - UNSATISFIED if ONE of the constraints is UNSATISFIED
  * - SATISFIED if ALL constraints are SATISFIED
  * - ALMOST if ONE of the constraints is ALMOST satisfied
+ *
+ * The check is performed by the kernel selected with
+ * Grid_select_kernel() (see grid_kernels.h).
  */
 
 int Grid_satisfied( Grid& g );
 
+/**
+ * Check grid one constraint after the other
+ */
+int Grid_satisfied_scalar( Grid& g );
+
 /**
  * Find all positions in a grid that are not set with a value 
  * between 1 and 9. Positions are return in a vector.
@@ -0,0 +1,279 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include "grid_kernels.h"
+#include "grid_state.h"
+
+#if defined(__x86_64__) or defined(__i386__)
+#define GRID_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+typedef int (*Grid_SatisfiedFunction)( Grid& g );
+
+// number of lanes used for the 27 units
+const int GRID_UNIT_LANES = 32;
+
+/**
+ * Index of the k-th cell of the units, lane u is unit u % 27:
+ * rows first, then columns and blocks
+ */
+typedef struct GridUnits {
+	alignas(32) int32_t _cells[ MAX_VAL ][ GRID_UNIT_LANES ];
+
+} GridUnits;
+
+static GridUnits GridUnits_build() {
+
+	GridUnits units;
+
+	for (int u = 0; u < GRID_UNIT_LANES; ++u) {
+
+		int unit = u % GRID_NBR_UNITS;
+
+		for (int k = 0; k < MAX_VAL; ++k) {
+			units._cells[ k ][ u ] = grid_tables._units[ unit ][ k ];
+		}
+	}
+
+	return units;
+
+}
+
+static const GridUnits grid_units = GridUnits_build();
+
+/**
+ * Copy the values of the cells into an array of bytes
+ */
+static inline void Grid_to_bytes( Grid& g, uint8_t *cells ) {
+
+#if GRID_CELL_BITS == 8
+	memcpy( cells, g._cells, GRID_NBR_CELLS );
+#else
+	for (int c = 0; c < GRID_NBR_CELLS; ++c) {
+		cells[ c ] = Grid_get_cell( g, c );
+	}
+#endif
+
+}
+
+#ifdef GRID_X86_KERNELS
+
+__attribute__(( target( "sse4.2" ) ))
+static int Grid_satisfied_sse4( Grid& g ) {
+
+	uint8_t cells[ GRID_NBR_CELLS ];
+	uint32_t masks[ GRID_NBR_CELLS ];
+
+	Grid_to_bytes( g, cells );
+
+	for (int c = 0; c < GRID_NBR_CELLS; ++c) {
+		masks[ c ] = (1U << (cells[ c ] & 0xF)) & FULL_MASK;
+	}
+
+	const int NBR_VECTORS = GRID_UNIT_LANES / 4;
+
+	__m128i seen[ NBR_VECTORS ], dup[ NBR_VECTORS ];
+
+	for (int j = 0; j < NBR_VECTORS; ++j) {
+		seen[ j ] = _mm_setzero_si128();
+		dup[ j ] = _mm_setzero_si128();
+	}
+
+	for (int k = 0; k < MAX_VAL; ++k) {
+
+		const int32_t *index = grid_units._cells[ k ];
+
+		for (int j = 0; j < NBR_VECTORS; ++j, index += 4) {
+
+			__m128i m = _mm_setr_epi32( masks[ index[ 0 ] ], masks[ index[ 1 ] ],
+				masks[ index[ 2 ] ], masks[ index[ 3 ] ] );
+
+			dup[ j ] = _mm_or_si128( dup[ j ], _mm_and_si128( seen[ j ], m ) );
+			seen[ j ] = _mm_or_si128( seen[ j ], m );
+		}
+	}
+
+	__m128i d = dup[ 0 ];
+	__m128i s = seen[ 0 ];
+
+	for (int j = 1; j < NBR_VECTORS; ++j) {
+		d = _mm_or_si128( d, dup[ j ] );
+		s = _mm_and_si128( s, seen[ j ] );
+	}
+
+	if (!_mm_testz_si128( d, d )) return UNSATISFIED;
+
+	__m128i full = _mm_set1_epi32( FULL_MASK );
+
+	return (_mm_movemask_epi8( _mm_cmpeq_epi32( s, full ) ) == 0xFFFF) ? SATISFIED : ALMOST;
+
+}
+
+
+__attribute__(( target( "avx2" ) ))
+static int Grid_satisfied_avx2( Grid& g ) {
+
+	// the gathers read 4 bytes from the index of the cell
+	alignas(32) uint8_t cells[ GRID_NBR_CELLS + 15 ];
+
+	Grid_to_bytes( g, cells );
+	memset( &cells[ GRID_NBR_CELLS ], 0, 15 );
+
+	const int NBR_VECTORS = GRID_UNIT_LANES / 8;
+
+	const __m256i one = _mm256_set1_epi32( 1 );
+	const __m256i low = _mm256_set1_epi32( 0xFF );
+	const __m256i full = _mm256_set1_epi32( FULL_MASK );
+
+	__m256i seen[ NBR_VECTORS ], dup[ NBR_VECTORS ];
+
+	for (int j = 0; j < NBR_VECTORS; ++j) {
+		seen[ j ] = _mm256_setzero_si256();
+		dup[ j ] = _mm256_setzero_si256();
+	}
+
+	for (int k = 0; k < MAX_VAL; ++k) {
+
+		const int32_t *index = grid_units._cells[ k ];
+
+		for (int j = 0; j < NBR_VECTORS; ++j, index += 8) {
+
+			__m256i i = _mm256_load_si256( reinterpret_cast<const __m256i *>( index ) );
+			__m256i v = _mm256_and_si256( _mm256_i32gather_epi32(
+				reinterpret_cast<const int *>( cells ), i, 1 ), low );
+			__m256i m = _mm256_and_si256( _mm256_sllv_epi32( one, v ), full );
+
+			dup[ j ] = _mm256_or_si256( dup[ j ], _mm256_and_si256( seen[ j ], m ) );
+			seen[ j ] = _mm256_or_si256( seen[ j ], m );
+		}
+	}
+
+	__m256i d = dup[ 0 ];
+	__m256i s = seen[ 0 ];
+
+	for (int j = 1; j < NBR_VECTORS; ++j) {
+		d = _mm256_or_si256( d, dup[ j ] );
+		s = _mm256_and_si256( s, seen[ j ] );
+	}
+
+	if (!_mm256_testz_si256( d, d )) return UNSATISFIED;
+
+	return (_mm256_movemask_epi8( _mm256_cmpeq_epi32( s, full ) ) == -1) ? SATISFIED : ALMOST;
+
+}
+
+#endif
+
+static bool Grid_scalar_supported() {
+	return true;
+}
+
+#ifdef GRID_X86_KERNELS
+
+// the kernels are selected before main() is called, so the features
+// of the processor must be initialized first
+static bool Grid_sse4_supported() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports( "sse4.2" );
+}
+
+static bool Grid_avx2_supported() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports( "avx2" );
+}
+
+#endif
+
+/**
+ * Kernels from the slowest to the fastest
+ */
+typedef struct GridKernel {
+	const char *_name;
+	Grid_SatisfiedFunction _function;
+	bool (*_supported)();
+
+} GridKernel;
+
+static GridKernel grid_kernels[] = {
+	{ "scalar", Grid_satisfied_scalar, Grid_scalar_supported },
+#ifdef GRID_X86_KERNELS
+	{ "sse4", Grid_satisfied_sse4, Grid_sse4_supported },
+	{ "avx2", Grid_satisfied_avx2, Grid_avx2_supported },
+#endif
+};
+
+const int NBR_GRID_KERNELS = sizeof( grid_kernels ) / sizeof( GridKernel );
+
+static int Grid_best_kernel() {
+
+	int best = 0;
+
+	for (int i = 0; i < NBR_GRID_KERNELS; ++i) {
+		if (grid_kernels[ i ]._supported()) best = i;
+	}
+
+	return best;
+
+}
+
+static int grid_kernel = Grid_best_kernel();
+
+
+bool Grid_select_kernel( const char *name ) {
+
+	if (strcmp( name, "auto" ) == 0) {
+		grid_kernel = Grid_best_kernel();
+		return true;
+	}
+
+	for (int i = 0; i < NBR_GRID_KERNELS; ++i) {
+		if (strcmp( name, grid_kernels[ i ]._name ) == 0) {
+			if (!grid_kernels[ i ]._supported()) return false;
+			grid_kernel = i;
+			return true;
+		}
+	}
+
+	return false;
+
+}
+
+
+const char *Grid_kernel_name() {
+
+	return grid_kernels[ grid_kernel ]._name;
+
+}
+
+
+int Grid_satisfied( Grid& g ) {
+
+	return grid_kernels[ grid_kernel ]._function( g );
+
+}
+
+
+void Grid_satisfied_bulk( Grid *grids, int nbr_grids, int *results ) {
+
+	Grid_SatisfiedFunction function = grid_kernels[ grid_kernel ]._function;
+
+	for (int i = 0; i < nbr_grids; ++i) {
+		results[ i ] = function( grids[ i ] );
+	}
+
+}
+
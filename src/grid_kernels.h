@@ -0,0 +1,57 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include "grid.h"
+
+/**
+ * Kernels that check the 27 constraints (rows, columns and blocks)
+ * of a grid, used by Grid_satisfied().
+ *
+ * The vector kernels process the 27 units at the same time, one
+ * unit per lane (the 5 last lanes repeat the first units). For each
+ * of the 9 cells of the units the value v of the cell is turned into
+ * the mask (1 << v) and the masks are accumulated:
+ *
+ *   dup  |= seen & mask
+ *   seen |= mask
+ *
+ * The grid is UNSATISFIED if one lane of dup is not 0, SATISFIED if
+ * all lanes of seen are equal to FULL_MASK and ALMOST otherwise.
+ *
+ * - "scalar" checks the units one after the other
+ * - "sse4" builds the masks of the cells then combines them by
+ *   groups of 4 units
+ * - "avx2" gathers the cells of 8 units and builds their masks
+ *   with a variable shift
+ *
+ * The best kernel supported by the processor is selected at start.
+ */
+
+/**
+ * Select kernel by name ("auto", "scalar", "sse4" or "avx2"), return
+ * false if the kernel is unknown or not supported by the processor
+ */
+bool Grid_select_kernel( const char *name );
+
+/**
+ * Return name of the kernel selected
+ */
+const char *Grid_kernel_name();
+
+/**
+ * Check all grids of an array, results[ i ] is the value returned
+ * by Grid_satisfied( grids[ i ] )
+ */
+void Grid_satisfied_bulk( Grid *grids, int nbr_grids, int *results );
+
@@ -0,0 +1,368 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include "grid.h"
+
+/**
+ * Grids of N×N cells where N = BOX×BOX: BOX = 3 for the usual 9×9
+ * grids, 4 for 16×16 grids and 5 for 25×25 grids.
+ *
+ * The size of the box is a parameter of the templates so that each
+ * size is compiled with its own constants: the divisions by the size
+ * are replaced by multiplications, the row, column and block of each
+ * cell are read from tables computed by the compiler and the sets of
+ * values use the smallest integer with enough bits (16 bits up to
+ * 16×16, 32 bits for 25×25).
+ *
+ * Unlike Grid, the cells, rows, columns and blocks are numbered from
+ * 0, only GridN_get() and GridN_set() use coordinates in [1..N].
+ * The 9×9 grids are stored in a Grid which has the SIMD kernels, the
+ * parallel searches and the GPU version, the sequential search with
+ * the MRV of the Solver copies them into a GridN<3> (see solver_n.h).
+ */
+
+/**
+ * Set of values of a grid with BOX×BOX values: bit v-1 is set if
+ * value v is used
+ */
+template <int BOX>
+using GridNMask = typename std::conditional< (BOX * BOX <= 16), uint16_t, uint32_t >::type;
+
+template <int BOX>
+struct GridNTraits {
+	// the values are read as '1' to '9' and 'A' to 'Z' (see GridN_value_of())
+	static_assert( (BOX >= 2) and (BOX * BOX <= 35), "the size of a box must be in [2..5]" );
+
+	// number of values and of cells of a row, column or block
+	static constexpr int SIZE = BOX * BOX;
+	// number of cells of the grid
+	static constexpr int NBR_CELLS = SIZE * SIZE;
+	// all values used
+	static constexpr GridNMask<BOX> FULL_MASK = static_cast< GridNMask<BOX> >( (1ULL << SIZE) - 1 );
+
+};
+
+/**
+ * Row, column and block of each cell and cells of each block
+ */
+template <int BOX>
+struct GridNUnits {
+	uint8_t _row[ GridNTraits<BOX>::NBR_CELLS ];
+	uint8_t _col[ GridNTraits<BOX>::NBR_CELLS ];
+	uint8_t _blk[ GridNTraits<BOX>::NBR_CELLS ];
+	uint16_t _blk_cells[ GridNTraits<BOX>::SIZE ][ GridNTraits<BOX>::SIZE ];
+
+};
+
+/**
+ * Compute the units of the cells, called by the compiler
+ */
+template <int BOX>
+constexpr GridNUnits<BOX> GridNUnits_make() {
+
+	const int SIZE = GridNTraits<BOX>::SIZE;
+
+	GridNUnits<BOX> u = {};
+
+	for (int c = 0; c < GridNTraits<BOX>::NBR_CELLS; ++c) {
+
+		int y = c / SIZE;
+		int x = c % SIZE;
+		int b = (y / BOX) * BOX + x / BOX;
+
+		u._row[ c ] = static_cast<uint8_t>( y );
+		u._col[ c ] = static_cast<uint8_t>( x );
+		u._blk[ c ] = static_cast<uint8_t>( b );
+		u._blk_cells[ b ][ (y % BOX) * BOX + x % BOX ] = static_cast<uint16_t>( c );
+	}
+
+	return u;
+
+}
+
+template <int BOX>
+struct GridNTables {
+	static constexpr GridNUnits<BOX> _units = GridNUnits_make<BOX>();
+
+};
+
+template <int BOX>
+constexpr GridNUnits<BOX> GridNTables<BOX>::_units;
+
+/**
+ * Grid of BOX^4 cells stored row after row, 0 is an empty cell
+ */
+template <int BOX>
+struct GridN {
+	uint8_t _cells[ GridNTraits<BOX>::NBR_CELLS ];
+
+};
+
+/**
+ * Fill all cells with 0
+ */
+template <int BOX>
+inline void GridN_init( GridN<BOX>& g ) {
+	memset( g._cells, ZERO, sizeof( g._cells ) );
+}
+
+/**
+ * Return value of cell (y,x) with y and x in [1..N]
+ */
+template <int BOX>
+inline int GridN_get( const GridN<BOX>& g, int y, int x ) {
+	return g._cells[ (y - 1) * GridNTraits<BOX>::SIZE + (x - 1) ];
+}
+
+/**
+ * Set value of cell (y,x) with y and x in [1..N]
+ */
+template <int BOX>
+inline void GridN_set( GridN<BOX>& g, int y, int x, int v ) {
+	g._cells[ (y - 1) * GridNTraits<BOX>::SIZE + (x - 1) ] = static_cast<uint8_t>( v );
+}
+
+/**
+ * Return the value of a character of a grid with 'size' values:
+ * '.' and '0' are empty cells, '1' to '9' are the values 1 to 9 and
+ * the letters 'A' to 'Z' (or 'a' to 'z') are the values 10 to 35 if
+ * they are less than or equal to size. Return -1 for a separator.
+ */
+inline int GridN_value_of( char c, int size ) {
+
+	int v = -1;
+
+	if (c == '.') v = ZERO;
+	else if (('0' <= c) and (c <= '9')) v = c - '0';
+	else if (('A' <= c) and (c <= 'Z')) v = c - 'A' + 10;
+	else if (('a' <= c) and (c <= 'z')) v = c - 'a' + 10;
+
+	return (v <= size) ? v : -1;
+
+}
+
+/**
+ * Return the character of value v, '.' for an empty cell
+ */
+inline char GridN_char_of( int v ) {
+	return (v == ZERO) ? '.' : ((v <= 9) ? static_cast<char>( '0' + v ) : static_cast<char>( 'A' + v - 10 ));
+}
+
+/**
+ * Read next grid from input stream: one character for each cell (see
+ * GridN_value_of()) on one line or on several lines, the other
+ * characters are ignored. When all cells are read the rest of the
+ * line is skipped.
+ *
+ * Return false if the end of the stream is reached before all cells
+ * could be read.
+ */
+template <int BOX>
+bool GridN_read( istream& in, GridN<BOX>& g ) {
+
+	GridN_init( g );
+
+	int count = 0;
+	string line;
+
+	while ((count < GridNTraits<BOX>::NBR_CELLS) and getline( in, line )) {
+
+		for (char c : line) {
+
+			int v = GridN_value_of( c, GridNTraits<BOX>::SIZE );
+
+			if (v < 0) continue;
+
+			g._cells[ count ] = static_cast<uint8_t>( v );
+
+			if (++count == GridNTraits<BOX>::NBR_CELLS) break;
+		}
+
+	}
+
+	return count == GridNTraits<BOX>::NBR_CELLS;
+
+}
+
+/**
+ * Return the values of the grid as a string of one character for
+ * each cell, an empty cell is a '.'
+ */
+template <int BOX>
+string GridN_to_string( const GridN<BOX>& g ) {
+
+	string s( GridNTraits<BOX>::NBR_CELLS, '.' );
+
+	for (int c = 0; c < GridNTraits<BOX>::NBR_CELLS; ++c) {
+		s[ c ] = GridN_char_of( g._cells[ c ] );
+	}
+
+	return s;
+
+}
+
+/**
+ * Print grid with the rows and the blocks separated
+ */
+template <int BOX>
+ostream& GridN_print( ostream& out, const GridN<BOX>& g ) {
+
+	const int SIZE = GridNTraits<BOX>::SIZE;
+
+	string line( 3 + BOX * (2 * BOX + 2), '-' );
+
+	out << line << endl;
+
+	for (int y = 1; y <= SIZE; ++y) {
+
+		out << setw( 2 ) << y << "|";
+
+		for (int x = 1; x <= SIZE; ++x) {
+			out << " " << GridN_char_of( GridN_get( g, y, x ) );
+			if ((x % BOX) == 0) out << " |";
+		}
+
+		out << endl;
+
+		if ((y % BOX) == 0) out << line << endl;
+	}
+
+	return out;
+
+}
+
+/**
+ * Values placed in the rows, columns and blocks of a grid and list
+ * of the empty cells, kept alongside the grid during the search
+ */
+template <int BOX>
+struct GridNState {
+	GridNMask<BOX> _rows[ GridNTraits<BOX>::SIZE ];
+	GridNMask<BOX> _cols[ GridNTraits<BOX>::SIZE ];
+	GridNMask<BOX> _blks[ GridNTraits<BOX>::SIZE ];
+	// the first _nbr_empty elements are the empty cells
+	uint16_t _empty[ GridNTraits<BOX>::NBR_CELLS ];
+	int _nbr_empty;
+
+};
+
+/**
+ * Return the set of values that can be placed in cell c
+ */
+template <int BOX>
+inline GridNMask<BOX> GridNState_candidates( const GridNState<BOX>& s, int c ) {
+
+	const GridNUnits<BOX>& u = GridNTables<BOX>::_units;
+
+	return GridNTraits<BOX>::FULL_MASK
+		& ~(s._rows[ u._row[ c ] ] | s._cols[ u._col[ c ] ] | s._blks[ u._blk[ c ] ]);
+
+}
+
+/**
+ * Record that value v is placed in (m = bit of v) or removed from
+ * cell c, it flips the bit of the value in the units of the cell
+ */
+template <int BOX>
+inline void GridNState_flip( GridNState<BOX>& s, int c, GridNMask<BOX> m ) {
+
+	const GridNUnits<BOX>& u = GridNTables<BOX>::_units;
+
+	s._rows[ u._row[ c ] ] ^= m;
+	s._cols[ u._col[ c ] ] ^= m;
+	s._blks[ u._blk[ c ] ] ^= m;
+
+}
+
+/**
+ * Initialize the state from the values of the grid.
+ *
+ * This function returns:
+ * - UNSATISFIED if a value appears twice in a row, column or block,
+ *   in this case the state is not usable
+ * - SATISFIED if all cells are set
+ * - ALMOST otherwise
+ */
+template <int BOX>
+int GridNState_init( GridNState<BOX>& s, const GridN<BOX>& g ) {
+
+	memset( &s, 0, sizeof( s ) );
+
+	for (int c = 0; c < GridNTraits<BOX>::NBR_CELLS; ++c) {
+
+		int v = g._cells[ c ];
+
+		if (v == ZERO) {
+			s._empty[ s._nbr_empty++ ] = static_cast<uint16_t>( c );
+			continue;
+		}
+
+		GridNMask<BOX> m = static_cast< GridNMask<BOX> >( 1ULL << (v - 1) );
+
+		if ((GridNState_candidates( s, c ) & m) == 0) {
+			return UNSATISFIED;
+		}
+
+		GridNState_flip( s, c, m );
+	}
+
+	return (s._nbr_empty == 0) ? SATISFIED : ALMOST;
+
+}
+
+/**
+ * Check if the grid satisfies the alldiff constraints of its rows,
+ * columns and blocks, with the same results as Grid_satisfied()
+ */
+template <int BOX>
+int GridN_satisfied( const GridN<BOX>& g ) {
+
+	GridNState<BOX> s;
+
+	return GridNState_init( s, g );
+
+}
+
+
+/**
+ * Copy a Grid into a 9×9 grid, the cells are numbered the same way
+ */
+inline void GridN_from_grid( const Grid& g, GridN<3>& n ) {
+
+	for (int c = 0; c < GRID_NBR_CELLS; ++c) {
+		n._cells[ c ] = static_cast<uint8_t>( Grid_get_cell( g, c ) );
+	}
+
+}
+
+/**
+ * Copy a 9×9 grid into a Grid
+ */
+inline void GridN_to_grid( const GridN<3>& n, Grid& g ) {
+
+	Grid_init( g );
+
+	for (int c = 0; c < GRID_NBR_CELLS; ++c) {
+		Grid_set_cell( g, c, n._cells[ c ] );
+	}
+
+}
+
+
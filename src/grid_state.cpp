@@ -0,0 +1,106 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include "grid_state.h"
+
+int GridState_init( GridState& s, Grid& g ) {
+
+	memset( &s, 0, sizeof( GridState ) );
+	s._empty[ 0 ] = ~static_cast<uint64_t>( 0 );
+	s._empty[ 1 ] = (static_cast<uint64_t>( 1 ) << (81 - 64)) - 1;
+
+	int nbr_set = 0;
+
+	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
+		for (int x = MIN_VAL; x <= MAX_VAL; ++x) {
+
+			GridElementType v = Grid_get( g, y, x );
+
+			if (v == ZERO) continue;
+
+			int b = Grid_block_of( y, x );
+
+			if (!GridState_can_place( s, y, x, b, v )) {
+				return UNSATISFIED;
+			}
+
+			GridState_place( s, y, x, b, v );
+			++nbr_set;
+		}
+	}
+
+	return (nbr_set == MAX_VAL * MAX_VAL) ? SATISFIED : ALMOST;
+
+}
+
+
+/**
+ * Number of empty cells in the row, column and block of cell c
+ */
+static inline int GridState_degree( GridState& s, int c ) {
+	return 27 - GridMask_count( s._rows[ grid_tables._row[ c ] ] )
+		- GridMask_count( s._cols[ grid_tables._col[ c ] ] )
+		- GridMask_count( s._blks[ grid_tables._blk[ c ] ] );
+}
+
+
+int GridState_select_mrv( GridState& s, int& y, int& x ) {
+
+	int best = -1;
+	int best_count = MAX_VAL + 1;
+	// the degree of the best cell is only computed on a tie
+	int best_degree = -1;
+
+	for (int w = 0; w < 2; ++w) {
+
+		uint64_t cells = s._empty[ w ];
+
+		while (cells != 0) {
+
+			int c = (w << 6) + __builtin_ctzll( cells );
+			cells &= cells - 1;
+
+			int count = GridMask_count( GridState_cell_candidates( s, c ) );
+
+			if (count < best_count) {
+				best = c;
+				best_count = count;
+				best_degree = -1;
+
+				// no better choice than a cell with 0 or 1 value
+				if (count <= 1) break;
+
+			} else if (count == best_count) {
+				if (best_degree < 0) best_degree = GridState_degree( s, best );
+				int degree = GridState_degree( s, c );
+				if (degree > best_degree) {
+					best = c;
+					best_degree = degree;
+				}
+			}
+		}
+
+		if (best_count <= 1) break;
+	}
+
+	if (best < 0) return -1;
+
+	y = grid_tables._row[ best ];
+	x = grid_tables._col[ best ];
+
+	return best_count;
+
+}
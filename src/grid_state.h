@@ -0,0 +1,164 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include "grid.h"
+#include "grid_tables.h"
+
+/**
+ * Set of digits stored as powers of 2: bit v is set if value v
+ * (from 1 to 9) is used. Bit 0 is never used.
+ */
+typedef uint16_t GridMask;
+
+// all values from 1 to 9 are used
+const GridMask FULL_MASK = 0x3FE;
+
+/**
+ * Return the number of values of the set m
+ */
+inline int GridMask_count( GridMask m ) {
+	return grid_tables._nbr_values[ m ];
+}
+
+/**
+ * State of the constraints of a grid that is kept alongside the
+ * grid during the search. For each row, column and block we record
+ * the values already placed so that checking if a value can be
+ * placed in a cell only requires a few bitwise operations instead
+ * of a full evaluation of the grid with Grid_satisfied().
+ *
+ * We also record the set of empty cells: bit c of _empty is set
+ * if cell c = (y-1)*9 + (x-1) is empty, cells 0 to 63 are stored
+ * in _empty[ 0 ] and cells 64 to 80 in _empty[ 1 ].
+ *
+ * Note that index 0 of the arrays is not used like for the Grid.
+ */
+typedef struct GridState {
+	GridMask _rows[ DIM ];
+	GridMask _cols[ DIM ];
+	GridMask _blks[ DIM ];
+	uint64_t _empty[ 2 ];
+
+} GridState;
+
+/**
+ * Return block (from 1 to 9) of the cell (y,x)
+ */
+inline int Grid_block_of( int y, int x ) {
+	return grid_tables._blk[ Grid_cell_of( y, x ) ];
+}
+
+/**
+ * Initialize the state from the values of the grid.
+ *
+ * This function returns:
+ * - UNSATISFIED if a value appears twice in a row, column or block,
+ *   in this case the state is not usable
+ * - SATISFIED if all cells are set
+ * - ALMOST otherwise
+ */
+int GridState_init( GridState& s, Grid& g );
+
+/**
+ * Return true if value v can be placed in cell (y,x) of block b
+ * without violating the alldiff constraints
+ */
+inline bool GridState_can_place( GridState& s, int y, int x, int b,
+		GridElementType v ) {
+
+	GridMask m = static_cast<GridMask>( 1 << v );
+	return ((s._rows[ y ] | s._cols[ x ] | s._blks[ b ]) & m) == 0;
+
+}
+
+/**
+ * Record that value v is placed in cell (y,x) of block b
+ */
+inline void GridState_place( GridState& s, int y, int x, int b,
+		GridElementType v ) {
+
+	GridMask m = static_cast<GridMask>( 1 << v );
+	s._rows[ y ] |= m;
+	s._cols[ x ] |= m;
+	s._blks[ b ] |= m;
+
+	int c = Grid_cell_of( y, x );
+	s._empty[ c >> 6 ] &= ~(static_cast<uint64_t>( 1 ) << (c & 63));
+
+}
+
+/**
+ * Record that value v is removed from cell (y,x) of block b
+ */
+inline void GridState_remove( GridState& s, int y, int x, int b,
+		GridElementType v ) {
+
+	GridMask m = static_cast<GridMask>( ~(1 << v) );
+	s._rows[ y ] &= m;
+	s._cols[ x ] &= m;
+	s._blks[ b ] &= m;
+
+	int c = Grid_cell_of( y, x );
+	s._empty[ c >> 6 ] |= static_cast<uint64_t>( 1 ) << (c & 63);
+
+}
+
+/**
+ * Satisfaction of the grid described by the state. As the state
+ * only records values that don't violate the constraints, the grid
+ * is SATISFIED if all rows are full, ALMOST otherwise.
+ */
+inline int GridState_satisfied( GridState& s ) {
+
+	GridMask m = FULL_MASK;
+	for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
+		m &= s._rows[ y ];
+	}
+
+	return (m == FULL_MASK) ? SATISFIED : ALMOST;
+
+}
+
+/**
+ * Return the set of values that can be placed in cell (y,x)
+ * of block b
+ */
+inline GridMask GridState_candidates( GridState& s, int y, int x, int b ) {
+	return FULL_MASK & ~(s._rows[ y ] | s._cols[ x ] | s._blks[ b ]);
+}
+
+/**
+ * Return the set of values that can be placed in cell c, the row,
+ * column and block of the cell are read from the tables
+ */
+inline GridMask GridState_cell_candidates( GridState& s, int c ) {
+	return FULL_MASK & ~(s._rows[ grid_tables._row[ c ] ]
+		| s._cols[ grid_tables._col[ c ] ] | s._blks[ grid_tables._blk[ c ] ]);
+}
+
+/**
+ * Minimum Remaining Values heuristic: select the empty cell with
+ * the fewest values allowed. Ties are broken by the degree of the
+ * cell, i.e. the number of empty cells in its row, column and block,
+ * the cell with the highest degree being the most constraining. The
+ * empty cells are read from the set kept up to date by
+ * GridState_place() and GridState_remove() and the degrees are only
+ * computed for the cells that tie on the number of values.
+ *
+ * Return the number of values allowed for the selected cell (y,x)
+ * or -1 if there is no empty cell left. A value of 0 means that
+ * the grid can't be solved.
+ */
+int GridState_select_mrv( GridState& s, int& y, int& x );
+
@@ -0,0 +1,111 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include "grid.h"
+#include "grid_n.h"
+
+/**
+ * Tables of the units of the cells of a grid, computed by the
+ * compiler, so that the checks and the searches don't divide the
+ * coordinates by 3 to find the block of a cell or the cells of a
+ * block. A cell is given by its index c = (y-1)*9 + (x-1) and the
+ * rows, columns and blocks are in [1..9] like for the Grid.
+ */
+
+// 9 rows, 9 columns and 9 blocks
+const int GRID_NBR_UNITS = 3 * MAX_VAL;
+// cells in the same row, column or block as a cell
+const int GRID_NBR_PEERS = 20;
+
+typedef struct GridTables {
+	// row, column and block of each cell
+	uint8_t _row[ GRID_NBR_CELLS ];
+	uint8_t _col[ GRID_NBR_CELLS ];
+	uint8_t _blk[ GRID_NBR_CELLS ];
+	// cells of each unit: units 0 to 8 are the rows, 9 to 17 the
+	// columns and 18 to 26 the blocks
+	uint8_t _units[ GRID_NBR_UNITS ][ MAX_VAL ];
+	// cells of each block, index 0 is not used
+	uint8_t _blk_cells[ DIM ][ MAX_VAL ];
+	// peers of each cell in increasing order
+	uint8_t _peers[ GRID_NBR_CELLS ][ GRID_NBR_PEERS ];
+	// number of bits set in each set of values (see GridMask), the
+	// builtin popcount is a function call when the compiler can't
+	// assume that the processor has the instruction
+	uint8_t _nbr_values[ 1 << DIM ];
+
+} GridTables;
+
+/**
+ * Compute the tables from the units of the grids of any size (see
+ * grid_n.h) numbered from 1, called by the compiler
+ */
+constexpr GridTables GridTables_make() {
+
+	GridNUnits<3> u = GridNUnits_make<3>();
+
+	GridTables t = {};
+
+	for (int c = 0; c < GRID_NBR_CELLS; ++c) {
+
+		t._row[ c ] = static_cast<uint8_t>( u._row[ c ] + 1 );
+		t._col[ c ] = static_cast<uint8_t>( u._col[ c ] + 1 );
+		t._blk[ c ] = static_cast<uint8_t>( u._blk[ c ] + 1 );
+
+		t._units[ u._row[ c ] ][ u._col[ c ] ] = static_cast<uint8_t>( c );
+		t._units[ MAX_VAL + u._col[ c ] ][ u._row[ c ] ] = static_cast<uint8_t>( c );
+	}
+
+	for (int b = 0; b < MAX_VAL; ++b) {
+		for (int k = 0; k < MAX_VAL; ++k) {
+			t._units[ 2 * MAX_VAL + b ][ k ] = static_cast<uint8_t>( u._blk_cells[ b ][ k ] );
+			t._blk_cells[ b + 1 ][ k ] = static_cast<uint8_t>( u._blk_cells[ b ][ k ] );
+		}
+	}
+
+	for (int c = 0; c < GRID_NBR_CELLS; ++c) {
+
+		int n = 0;
+
+		for (int d = 0; d < GRID_NBR_CELLS; ++d) {
+
+			if (d == c) continue;
+
+			if ((t._row[ d ] == t._row[ c ]) or (t._col[ d ] == t._col[ c ])
+					or (t._blk[ d ] == t._blk[ c ])) {
+				t._peers[ c ][ n++ ] = static_cast<uint8_t>( d );
+			}
+		}
+	}
+
+	for (int m = 1; m < (1 << DIM); ++m) {
+		t._nbr_values[ m ] = static_cast<uint8_t>( (m & 1) + t._nbr_values[ m >> 1 ] );
+	}
+
+	return t;
+
+}
+
+/**
+ * Tables of the library, defined in grid.cpp
+ */
+extern const GridTables grid_tables;
+
+/**
+ * Return index of cell (y,x)
+ */
+GRID_FUNCTION int Grid_cell_of( int y, int x ) {
+	return (y - 1) * MAX_VAL + (x - 1);
+}
+
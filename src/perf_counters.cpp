@@ -0,0 +1,205 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include <iomanip>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "perf_counters.h"
+
+using namespace std;
+
+typedef struct PerfEvent {
+	const char *_name;
+	uint32_t _type;
+	uint64_t _config;
+
+} PerfEvent;
+
+// read misses of a cache
+#define PERF_CACHE_READ_MISS( cache ) \
+	((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const PerfEvent perf_events[ PERF_NBR_EVENTS ] = {
+	{ "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	{ "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+	{ "branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+	{ "l1d_misses", PERF_TYPE_HW_CACHE, PERF_CACHE_READ_MISS( PERF_COUNT_HW_CACHE_L1D ) },
+	{ "llc_misses", PERF_TYPE_HW_CACHE, PERF_CACHE_READ_MISS( PERF_COUNT_HW_CACHE_LL ) }
+};
+
+/**
+ * Open event e for the calling thread on any processor, the event is
+ * disabled. Return -1 if the event can't be opened.
+ */
+static int PerfCounters_open( int e ) {
+
+	struct perf_event_attr attr;
+
+	memset( &attr, 0, sizeof( attr ) );
+	attr.size = sizeof( attr );
+	attr.type = perf_events[ e ]._type;
+	attr.config = perf_events[ e ]._config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	return static_cast<int>( syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 ) );
+
+}
+
+
+void PerfCounters_init( PerfCounters& pc ) {
+
+	for (int e = 0; e < PERF_NBR_EVENTS; ++e) {
+		pc._fds[ e ] = -1;
+		pc._values[ e ] = 0;
+		pc._available[ e ] = false;
+	}
+
+}
+
+
+bool PerfCounters_start( PerfCounters& pc ) {
+
+	bool started = false;
+
+	for (int e = 0; e < PERF_NBR_EVENTS; ++e) {
+
+		pc._fds[ e ] = PerfCounters_open( e );
+
+		if (pc._fds[ e ] >= 0) {
+			pc._available[ e ] = true;
+			started = true;
+		}
+	}
+
+	// the events start at the same time once they are all open
+	for (int e = 0; e < PERF_NBR_EVENTS; ++e) {
+		if (pc._fds[ e ] >= 0) {
+			ioctl( pc._fds[ e ], PERF_EVENT_IOC_RESET, 0 );
+			ioctl( pc._fds[ e ], PERF_EVENT_IOC_ENABLE, 0 );
+		}
+	}
+
+	return started;
+
+}
+
+
+void PerfCounters_stop( PerfCounters& pc ) {
+
+	for (int e = 0; e < PERF_NBR_EVENTS; ++e) {
+		if (pc._fds[ e ] >= 0) ioctl( pc._fds[ e ], PERF_EVENT_IOC_DISABLE, 0 );
+	}
+
+	for (int e = 0; e < PERF_NBR_EVENTS; ++e) {
+
+		if (pc._fds[ e ] < 0) continue;
+
+		// value, time enabled and time running
+		uint64_t data[ 3 ];
+
+		if ((read( pc._fds[ e ], data, sizeof( data ) ) == sizeof( data )) and (data[ 2 ] > 0)) {
+			double scale = static_cast<double>( data[ 1 ] ) / data[ 2 ];
+			pc._values[ e ] += static_cast<uint64_t>( data[ 0 ] * scale );
+		}
+
+		close( pc._fds[ e ] );
+		pc._fds[ e ] = -1;
+	}
+
+}
+
+
+void PerfCounters_add( PerfCounters& total, PerfCounters& pc ) {
+
+	for (int e = 0; e < PERF_NBR_EVENTS; ++e) {
+		total._values[ e ] += pc._values[ e ];
+		total._available[ e ] = total._available[ e ] or pc._available[ e ];
+	}
+
+}
+
+
+bool PerfCounters_available( PerfCounters& pc ) {
+
+	for (int e = 0; e < PERF_NBR_EVENTS; ++e) {
+		if (pc._available[ e ]) return true;
+	}
+
+	return false;
+
+}
+
+
+void PerfCounters_print_header( ostream& out ) {
+
+	out << setw( 16 ) << "cycles" << setw( 16 ) << "instructions" << setw( 7 ) << "ipc"
+		<< setw( 14 ) << "branch-misses" << setw( 14 ) << "l1d-misses" << setw( 14 ) << "llc-misses";
+
+}
+
+
+void PerfCounters_print( ostream& out, PerfCounters& pc ) {
+
+	const int widths[ PERF_NBR_EVENTS ] = { 16, 16, 14, 14, 14 };
+
+	for (int e = 0; e < PERF_NBR_EVENTS; ++e) {
+
+		out << setw( widths[ e ] );
+		if (pc._available[ e ]) out << pc._values[ e ]; else out << "n/a";
+
+		if (e == PERF_INSTRUCTIONS) {
+			out << setw( 7 );
+			if (pc._available[ PERF_CYCLES ] and pc._available[ PERF_INSTRUCTIONS ]
+					and (pc._values[ PERF_CYCLES ] > 0)) {
+				out << fixed << setprecision( 2 )
+					<< static_cast<double>( pc._values[ PERF_INSTRUCTIONS ] ) / pc._values[ PERF_CYCLES ];
+			} else {
+				out << "n/a";
+			}
+		}
+	}
+
+}
+
+
+void PerfCounters_print_json( ostream& out, PerfCounters& pc, double divisor ) {
+
+	out << fixed << setprecision( 2 );
+
+	for (int e = 0; e < PERF_NBR_EVENTS; ++e) {
+
+		out << ((e == 0) ? "" : ", ") << "\"" << perf_events[ e ]._name << "\": ";
+		if (!pc._available[ e ]) out << "null";
+		else if (divisor == 1) out << pc._values[ e ];
+		else out << pc._values[ e ] / divisor;
+	}
+
+	out << ", \"ipc\": ";
+	if (pc._available[ PERF_CYCLES ] and pc._available[ PERF_INSTRUCTIONS ]
+			and (pc._values[ PERF_CYCLES ] > 0)) {
+		out << static_cast<double>( pc._values[ PERF_INSTRUCTIONS ] ) / pc._values[ PERF_CYCLES ];
+	} else {
+		out << "null";
+	}
+
+}
+
@@ -0,0 +1,86 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <ostream>
+#include <cstdint>
+
+/**
+ * Hardware counters of the thread that starts them, read with the
+ * perf_event_open() system call of Linux. Each event is opened on its
+ * own so that an event that is not supported (virtual machine, kernel
+ * without the event or /proc/sys/kernel/perf_event_paranoid too high)
+ * is only missing from the results. When the kernel shares the
+ * counters between more events than the processor has, the values
+ * are scaled by the time the events were counted.
+ */
+
+// events counted
+const int PERF_CYCLES        = 0;
+const int PERF_INSTRUCTIONS  = 1;
+const int PERF_BRANCH_MISSES = 2;
+const int PERF_L1D_MISSES    = 3;
+const int PERF_LLC_MISSES    = 4;
+const int PERF_NBR_EVENTS    = 5;
+
+typedef struct PerfCounters {
+	// file descriptors of the events while they are counted
+	int _fds[ PERF_NBR_EVENTS ];
+	// sum of the values of the events from start to stop
+	uint64_t _values[ PERF_NBR_EVENTS ];
+	// the event could be counted
+	bool _available[ PERF_NBR_EVENTS ];
+
+} PerfCounters;
+
+/**
+ * Reset the values of the counters
+ */
+void PerfCounters_init( PerfCounters& pc );
+
+/**
+ * Open the events for the calling thread and start counting. Return
+ * false if no event can be counted.
+ */
+bool PerfCounters_start( PerfCounters& pc );
+
+/**
+ * Stop counting, add the values of the events to the counters and
+ * close the events
+ */
+void PerfCounters_stop( PerfCounters& pc );
+
+/**
+ * Add the counters of pc to total
+ */
+void PerfCounters_add( PerfCounters& total, PerfCounters& pc );
+
+/**
+ * Return true if at least one event could be counted
+ */
+bool PerfCounters_available( PerfCounters& pc );
+
+/**
+ * Print the header of the columns and one line with the values of
+ * the counters and the instructions per cycle ("n/a" for the events
+ * that are not available)
+ */
+void PerfCounters_print_header( std::ostream& out );
+void PerfCounters_print( std::ostream& out, PerfCounters& pc );
+
+/**
+ * Print the counters divided by 'divisor' as the members of a JSON
+ * object, null for the events that are not available
+ */
+void PerfCounters_print_json( std::ostream& out, PerfCounters& pc, double divisor = 1 );
+
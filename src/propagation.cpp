@@ -0,0 +1,146 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include "propagation.h"
+
+/**
+ * Values placed in unit u
+ */
+static inline GridMask GridState_unit_values( GridState& s, int u ) {
+
+	if (u < 9) return s._rows[ u + 1 ];
+	if (u < 18) return s._cols[ u - 9 + 1 ];
+	return s._blks[ u - 18 + 1 ];
+
+}
+
+/**
+ * Set all naked singles, return -1 on contradiction or the number
+ * of positions set. All empty cells are looked at once, then only
+ * the peers of the cells set since the values allowed of the other
+ * cells don't change.
+ */
+static int Grid_propagate_naked_singles( Grid& g, GridState& s, Trail& t ) {
+
+	int count = 0;
+
+	// cells to look at, a cell can be pushed several times
+	uint8_t stack[ GRID_NBR_CELLS * (GRID_NBR_PEERS + 1) ];
+	int size = 0;
+
+	for (int cell = GRID_NBR_CELLS - 1; cell >= 0; --cell) {
+		if (Grid_get_cell( g, cell ) == ZERO) stack[ size++ ] = static_cast<uint8_t>( cell );
+	}
+
+	while (size > 0) {
+
+		int cell = stack[ --size ];
+
+		if (Grid_get_cell( g, cell ) != ZERO) continue;
+
+		GridMask c = GridState_cell_candidates( s, cell );
+
+		if (c == 0) return -1;
+
+		if ((c & (c - 1)) == 0) {
+
+			Grid_assign( g, s, t, grid_tables._row[ cell ], grid_tables._col[ cell ], __builtin_ctz( c ) );
+			++count;
+
+			const uint8_t *peers = grid_tables._peers[ cell ];
+
+			for (int k = 0; k < GRID_NBR_PEERS; ++k) {
+				if (Grid_get_cell( g, peers[ k ] ) == ZERO) stack[ size++ ] = peers[ k ];
+			}
+		}
+	}
+
+	return count;
+
+}
+
+/**
+ * Set all hidden singles, return -1 on contradiction or the number
+ * of positions set
+ */
+static int Grid_propagate_hidden_singles( Grid& g, GridState& s, Trail& t ) {
+
+	int count = 0;
+
+	for (int u = 0; u < GRID_NBR_UNITS; ++u) {
+
+		const uint8_t *cells = grid_tables._units[ u ];
+
+		// values allowed in at least one cell and in at least two
+		// cells of the unit
+		GridMask once = 0, twice = 0;
+
+		for (int k = 0; k < 9; ++k) {
+
+			if (Grid_get_cell( g, cells[ k ] ) != ZERO) continue;
+
+			GridMask c = GridState_cell_candidates( s, cells[ k ] );
+			twice |= once & c;
+			once |= c;
+		}
+
+		GridMask placed = GridState_unit_values( s, u );
+
+		if ((once | placed) != FULL_MASK) return -1;
+
+		GridMask hidden = once & ~twice;
+
+		while (hidden != 0) {
+
+			GridElementType v = __builtin_ctz( hidden );
+			hidden &= hidden - 1;
+
+			for (int k = 0; k < 9; ++k) {
+				int c = cells[ k ];
+
+				if (Grid_get_cell( g, c ) != ZERO) continue;
+
+				if ((GridState_cell_candidates( s, c ) & (1 << v)) != 0) {
+					Grid_assign( g, s, t, grid_tables._row[ c ], grid_tables._col[ c ], v );
+					++count;
+					break;
+				}
+			}
+		}
+	}
+
+	return count;
+
+}
+
+
+bool Grid_propagate( Grid& g, GridState& s, Trail& t ) {
+
+	while (true) {
+
+		int n = Grid_propagate_naked_singles( g, s, t );
+		if (n < 0) return false;
+
+		int h = Grid_propagate_hidden_singles( g, s, t );
+		if (h < 0) return false;
+
+		if ((n + h) == 0) break;
+
+	}
+
+	return true;
+
+}
@@ -0,0 +1,83 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include "grid.h"
+#include "grid_state.h"
+
+/**
+ * Trail of the positions set during the search (by the solver or
+ * by the propagation) in the order they were set, so that they can
+ * be reset when we backtrack.
+ */
+typedef struct Trail {
+	Position _positions[ MAX_VAL * MAX_VAL ];
+	int _size;
+
+} Trail;
+
+/**
+ * Initialize trail as empty
+ */
+inline void Trail_init( Trail& t ) {
+	t._size = 0;
+}
+
+/**
+ * Set value v in cell (y,x), update the state and record the
+ * position in the trail. The value must be allowed by the state.
+ */
+inline void Grid_assign( Grid& g, GridState& s, Trail& t, int y, int x,
+		GridElementType v ) {
+
+	Grid_set( g, y, x, v );
+	GridState_place( s, y, x, Grid_block_of( y, x ), v );
+
+	Position& p = t._positions[ t._size++ ];
+	p._y = y;
+	p._x = x;
+
+}
+
+/**
+ * Reset all positions recorded in the trail after the given mark
+ * (the size of the trail before the positions were set)
+ */
+inline void Trail_undo( Grid& g, GridState& s, Trail& t, int mark ) {
+
+	while (t._size > mark) {
+
+		Position& p = t._positions[ --t._size ];
+
+		GridState_remove( s, p._y, p._x, Grid_block_of( p._y, p._x ), Grid_get( g, p._y, p._x ) );
+		Grid_set( g, p._y, p._x, ZERO );
+
+	}
+
+}
+
+/**
+ * Apply the constraint propagation until a fixpoint is reached:
+ * - naked single: an empty cell has only one value allowed
+ * - hidden single: a value can only be placed in one cell of a
+ *   row, column or block
+ *
+ * The positions set are recorded in the trail.
+ *
+ * Return false if the propagation leads to a contradiction (a cell
+ * without any value allowed or a value that can't be placed in a
+ * row, column or block). The positions set must then be reset with
+ * Trail_undo().
+ */
+bool Grid_propagate( Grid& g, GridState& s, Trail& t );
+
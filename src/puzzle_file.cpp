@@ -0,0 +1,99 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "puzzle_file.h"
+
+bool PuzzleFile_open( PuzzleFile& pf, const char *file_name ) {
+
+	pf._data = nullptr;
+	pf._size = 0;
+	pf._offset = 0;
+
+	pf._fd = open( file_name, O_RDONLY );
+
+	if (pf._fd < 0) return false;
+
+	struct stat st;
+
+	if (fstat( pf._fd, &st ) < 0) {
+		close( pf._fd );
+		pf._fd = -1;
+		return false;
+	}
+
+	pf._size = st.st_size;
+
+	// an empty file can't be mapped but is valid
+	if (pf._size == 0) return true;
+
+	void *data = mmap( nullptr, pf._size, PROT_READ, MAP_PRIVATE, pf._fd, 0 );
+
+	if (data == MAP_FAILED) {
+		close( pf._fd );
+		pf._fd = -1;
+		pf._size = 0;
+		return false;
+	}
+
+	// the file is read once from the beginning to the end
+	madvise( data, pf._size, MADV_SEQUENTIAL );
+
+	pf._data = static_cast<const char *>( data );
+
+	return true;
+
+}
+
+
+void PuzzleFile_close( PuzzleFile& pf ) {
+
+	if (pf._data != nullptr) {
+		munmap( const_cast<char *>( pf._data ), pf._size );
+		pf._data = nullptr;
+	}
+
+	if (pf._fd >= 0) {
+		close( pf._fd );
+		pf._fd = -1;
+	}
+
+}
+
+
+bool PuzzleFile_next( PuzzleFile& pf, Grid& g ) {
+
+	if (pf._offset >= pf._size) return false;
+
+	const char *end = pf._data + pf._size;
+	const char *p = Grid_parse( g, pf._data + pf._offset, end );
+
+	if (p == nullptr) {
+		pf._offset = pf._size;
+		return false;
+	}
+
+	const char *eol = static_cast<const char *>( memchr( p, '\n', end - p ) );
+
+	pf._offset = (eol == nullptr) ? pf._size : (eol + 1) - pf._data;
+
+	return true;
+
+}
+
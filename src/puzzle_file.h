@@ -0,0 +1,49 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include "grid.h"
+
+/**
+ * File of grids mapped in memory.
+ *
+ * The grids are parsed directly from the bytes of the file (see
+ * Grid_parse()) without copying the file into a string, so that
+ * large files of puzzles can be read at the speed of the disk.
+ */
+typedef struct PuzzleFile {
+	int _fd;
+	// bytes of the file
+	const char *_data;
+	size_t _size;
+	// offset of the next grid
+	size_t _offset;
+
+} PuzzleFile;
+
+/**
+ * Open and map file, return false if the file can't be opened
+ */
+bool PuzzleFile_open( PuzzleFile& pf, const char *file_name );
+
+/**
+ * Unmap and close file
+ */
+void PuzzleFile_close( PuzzleFile& pf );
+
+/**
+ * Read next grid of the file, the rest of the line of its last value
+ * is skipped. Return false if there is no grid left.
+ */
+bool PuzzleFile_next( PuzzleFile& pf, Grid& g );
+
@@ -0,0 +1,462 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "puzzle_store.h"
+
+const char PUZZLE_STORE_MAGIC[ 8 ] = { 'S', 'U', 'D', 'O', 'K', 'U', 'S', 'T' };
+const uint32_t PUZZLE_STORE_VERSION = 2;
+
+/**
+ * FNV-1a hash of the key
+ */
+static uint64_t PuzzleStore_hash( const uint8_t *key ) {
+
+	uint64_t h = 0xcbf29ce484222325ULL;
+
+	for (int i = 0; i < GRID_PACKED_SIZE; ++i) {
+		h ^= key[ i ];
+		h *= 0x100000001b3ULL;
+	}
+
+	return h;
+
+}
+
+/**
+ * Return the entries of the table of header h
+ */
+static inline PuzzleStoreEntry *PuzzleStore_entries( PuzzleStoreHeader *h ) {
+
+	return reinterpret_cast<PuzzleStoreEntry *>( h + 1 );
+
+}
+
+/**
+ * Check that the mapped file of size bytes is a store
+ */
+static bool PuzzleStore_check( PuzzleStoreHeader& h, size_t size ) {
+
+	if (memcmp( h._magic, PUZZLE_STORE_MAGIC, sizeof( PUZZLE_STORE_MAGIC ) ) != 0) return false;
+	if (h._version != PUZZLE_STORE_VERSION) return false;
+	if (h._entry_size != sizeof( PuzzleStoreEntry )) return false;
+	if ((h._capacity == 0) or ((h._capacity & (h._capacity - 1)) != 0)) return false;
+
+	return size == sizeof( PuzzleStoreHeader ) + h._capacity * sizeof( PuzzleStoreEntry );
+
+}
+
+/**
+ * Write the header of an empty table of capacity entries in the empty
+ * file fd
+ */
+static bool PuzzleStore_create( int fd, uint64_t capacity ) {
+
+	PuzzleStoreHeader h;
+	memset( &h, 0, sizeof( h ) );
+	memcpy( h._magic, PUZZLE_STORE_MAGIC, sizeof( PUZZLE_STORE_MAGIC ) );
+	h._version = PUZZLE_STORE_VERSION;
+	h._entry_size = sizeof( PuzzleStoreEntry );
+	h._capacity = capacity;
+	h._nbr_entries = 0;
+	h._moved = 0;
+
+	return (ftruncate( fd, sizeof( h ) + capacity * sizeof( PuzzleStoreEntry ) ) == 0)
+		and (pwrite( fd, &h, sizeof( h ), 0 ) == sizeof( h ));
+
+}
+
+/**
+ * Map file fd in memory. Return false if the file can't be mapped or
+ * is not a store.
+ */
+static bool PuzzleStore_map( PuzzleStoreMap& m, int fd, bool read_only ) {
+
+	struct stat sb;
+
+	if ((fstat( fd, &sb ) != 0) or (sb.st_size < (off_t) sizeof( PuzzleStoreHeader ))) return false;
+
+	void *addr = mmap( nullptr, sb.st_size, read_only ? PROT_READ : PROT_READ | PROT_WRITE,
+		MAP_SHARED, fd, 0 );
+
+	if (addr == MAP_FAILED) return false;
+
+	m._fd = fd;
+	m._size = sb.st_size;
+	m._header = reinterpret_cast<PuzzleStoreHeader *>( addr );
+
+	if (!PuzzleStore_check( *m._header, m._size )) {
+		munmap( addr, m._size );
+		return false;
+	}
+
+	return true;
+
+}
+
+/**
+ * Unmap and close file of the store
+ */
+static void PuzzleStore_unmap( PuzzleStoreMap& m, bool read_only ) {
+
+	if (!read_only) msync( m._header, m._size, MS_SYNC );
+	munmap( m._header, m._size );
+	close( m._fd );
+
+}
+
+/**
+ * Replace the current file of the store by map m, the current file
+ * is kept until the store is closed
+ */
+static void PuzzleStore_switch( PuzzleStore& st, PuzzleStoreMap& m ) {
+
+	st._old_maps.push_back( st._map );
+	st._map = m;
+	st._header.store( m._header, std::memory_order_release );
+
+}
+
+/**
+ * Map the file of the name of the store when the current file has
+ * been moved, called with the mutex of the store
+ */
+static bool PuzzleStore_reopen( PuzzleStore& st ) {
+
+	int fd = open( st._name.c_str(), st._read_only ? O_RDONLY : O_RDWR );
+
+	if (fd < 0) return false;
+
+	PuzzleStoreMap m;
+
+	if (!PuzzleStore_map( m, fd, st._read_only )) {
+		close( fd );
+		return false;
+	}
+
+	PuzzleStore_switch( st, m );
+
+	return true;
+
+}
+
+/**
+ * Return true if the table of header h was copied to a larger file
+ */
+static inline bool PuzzleStore_moved( PuzzleStoreHeader *h ) {
+
+	return __atomic_load_n( &h->_moved, __ATOMIC_ACQUIRE ) != 0;
+
+}
+
+/**
+ * Return the entry of key in table h, or the empty entry where it
+ * can be added. The table always has empty entries.
+ */
+static PuzzleStoreEntry *PuzzleStore_slot( PuzzleStoreHeader *h, const uint8_t *key ) {
+
+	PuzzleStoreEntry *entries = PuzzleStore_entries( h );
+
+	uint64_t capacity = h->_capacity;
+	uint64_t i = PuzzleStore_hash( key ) & (capacity - 1);
+
+	while ((entries[ i ]._version != 0) and (memcmp( entries[ i ]._key, key, GRID_PACKED_SIZE ) != 0)) {
+		i = (i + 1) & (capacity - 1);
+	}
+
+	return &entries[ i ];
+
+}
+
+/**
+ * Lock the current file of the store for the writers of the other
+ * processes, the files moved by the other processes are followed.
+ * Called with the mutex of the store, return false if the new file
+ * can't be opened.
+ */
+static bool PuzzleStore_lock( PuzzleStore& st ) {
+
+	while (true) {
+
+		flock( st._map._fd, LOCK_EX );
+
+		if (!PuzzleStore_moved( st._map._header )) return true;
+
+		flock( st._map._fd, LOCK_UN );
+
+		if (!PuzzleStore_reopen( st )) return false;
+	}
+
+}
+
+/**
+ * Copy the table into a new file with twice as many entries which
+ * replaces the file of the store. Called with the current file
+ * locked, the new file is locked instead when the function returns
+ * true.
+ */
+static bool PuzzleStore_grow( PuzzleStore& st ) {
+
+	PuzzleStoreHeader *h = st._map._header;
+
+	// only the process that has the lock of the current file grows it
+	std::string tmp_name = st._name + ".grow";
+
+	int fd = open( tmp_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+
+	if (fd < 0) return false;
+
+	flock( fd, LOCK_EX );
+
+	PuzzleStoreMap m;
+
+	if (!PuzzleStore_create( fd, 2 * h->_capacity ) or !PuzzleStore_map( m, fd, false )) {
+		close( fd );
+		unlink( tmp_name.c_str() );
+		return false;
+	}
+
+	// no entry is written since the writers are locked
+	PuzzleStoreEntry *entries = PuzzleStore_entries( h );
+
+	for (uint64_t i = 0; i < h->_capacity; ++i) {
+
+		if (entries[ i ]._version == 0) continue;
+
+		*PuzzleStore_slot( m._header, entries[ i ]._key ) = entries[ i ];
+		++m._header->_nbr_entries;
+	}
+
+	if ((msync( m._header, m._size, MS_SYNC ) != 0)
+			or (rename( tmp_name.c_str(), st._name.c_str() ) != 0)) {
+		PuzzleStore_unmap( m, false );
+		unlink( tmp_name.c_str() );
+		return false;
+	}
+
+	__atomic_store_n( &h->_moved, 1, __ATOMIC_RELEASE );
+
+	flock( st._map._fd, LOCK_UN );
+
+	PuzzleStore_switch( st, m );
+
+	return true;
+
+}
+
+
+bool PuzzleStore_open( PuzzleStore& st, const char *name, uint64_t capacity ) {
+
+	st._name = name;
+	st._header = nullptr;
+	st._old_maps.clear();
+	st._nbr_hits = 0;
+	st._nbr_misses = 0;
+	st._nbr_refused = 0;
+
+	st._read_only = false;
+	int fd = open( name, O_RDWR | O_CREAT, 0644 );
+
+	if (fd < 0) {
+		st._read_only = true;
+		fd = open( name, O_RDONLY );
+	}
+
+	if (fd < 0) return false;
+
+	bool ok = true;
+
+	if (!st._read_only) {
+
+		// the first process that opens the file creates the table
+		flock( fd, LOCK_EX );
+
+		struct stat sb;
+		ok = (fstat( fd, &sb ) == 0);
+
+		if (ok and (sb.st_size == 0)) ok = PuzzleStore_create( fd, capacity );
+
+		flock( fd, LOCK_UN );
+	}
+
+	if (!ok or !PuzzleStore_map( st._map, fd, st._read_only )) {
+		close( fd );
+		return false;
+	}
+
+	st._header = st._map._header;
+
+	return true;
+
+}
+
+
+void PuzzleStore_close( PuzzleStore& st ) {
+
+	if (st._header == nullptr) return;
+
+	PuzzleStore_unmap( st._map, st._read_only );
+
+	for (PuzzleStoreMap& m : st._old_maps) {
+		PuzzleStore_unmap( m, true );
+	}
+
+	st._old_maps.clear();
+	st._header = nullptr;
+
+}
+
+
+bool PuzzleStore_find( PuzzleStore& st, Grid& g, long max_solutions, CacheResult& r ) {
+
+	uint8_t key[ GRID_PACKED_SIZE ];
+
+	Grid_pack( g, key );
+
+	PuzzleStoreHeader *h = st._header.load( std::memory_order_acquire );
+
+	// the table was grown by another process
+	if (PuzzleStore_moved( h )) {
+
+		std::lock_guard<std::mutex> lock( st._mutex );
+
+		if (st._map._header == h) PuzzleStore_reopen( st );
+		h = st._map._header;
+	}
+
+	PuzzleStoreEntry *entries = PuzzleStore_entries( h );
+
+	uint64_t capacity = h->_capacity;
+	uint64_t i = PuzzleStore_hash( key ) & (capacity - 1);
+
+	for (uint64_t n = 0; n < capacity; ++n, i = (i + 1) & (capacity - 1)) {
+
+		PuzzleStoreEntry& e = entries[ i ];
+
+		uint32_t version = __atomic_load_n( &e._version, __ATOMIC_ACQUIRE );
+
+		if (version == 0) break;
+		// the entry is written
+		if ((version & 1) != 0) continue;
+
+		PuzzleStoreEntry copy;
+		memcpy( &copy, &e, sizeof( copy ) );
+
+		__atomic_thread_fence( __ATOMIC_ACQUIRE );
+
+		// the entry was modified while it was read
+		if (__atomic_load_n( &e._version, __ATOMIC_RELAXED ) != version) continue;
+
+		if (memcmp( copy._key, key, GRID_PACKED_SIZE ) != 0) continue;
+
+		CacheResult cached;
+		cached._nbr_solutions = copy._nbr_solutions;
+		cached._max_solutions = copy._max_solutions;
+		Grid_unpack( cached._first_solution, copy._first_solution );
+
+		if (!CacheResult_get( cached, max_solutions, r )) break;
+
+		++st._nbr_hits;
+		return true;
+	}
+
+	++st._nbr_misses;
+	return false;
+
+}
+
+
+bool PuzzleStore_insert( PuzzleStore& st, Grid& g, CacheResult& r ) {
+
+	if (st._read_only) {
+		++st._nbr_refused;
+		return false;
+	}
+
+	uint8_t key[ GRID_PACKED_SIZE ];
+
+	Grid_pack( g, key );
+
+	std::lock_guard<std::mutex> lock( st._mutex );
+
+	if (!PuzzleStore_lock( st )) {
+		++st._nbr_refused;
+		return false;
+	}
+
+	PuzzleStoreHeader *h = st._map._header;
+	PuzzleStoreEntry *e = PuzzleStore_slot( h, key );
+
+	bool write_flag = false;
+
+	if (e->_version == 0) {
+
+		// keep a quarter of the entries empty so that the probes stay
+		// short
+		if (h->_nbr_entries >= h->_capacity - h->_capacity / 4) {
+
+			if (!PuzzleStore_grow( st )) {
+				flock( st._map._fd, LOCK_UN );
+				++st._nbr_refused;
+				return false;
+			}
+
+			h = st._map._header;
+			e = PuzzleStore_slot( h, key );
+		}
+
+		write_flag = true;
+		++h->_nbr_entries;
+
+	} else {
+
+		// a result that found all solutions is kept, a stopped search
+		// is replaced by a search that found more solutions
+		bool complete = (e->_max_solutions == 0) or (e->_nbr_solutions < e->_max_solutions);
+		bool r_complete = (r._max_solutions == 0) or (r._nbr_solutions < r._max_solutions);
+
+		write_flag = !complete and (r_complete or (r._nbr_solutions > e->_nbr_solutions));
+	}
+
+	if (write_flag) {
+
+		uint32_t version = e->_version | 1;
+
+		__atomic_store_n( &e->_version, version, __ATOMIC_RELAXED );
+		__atomic_thread_fence( __ATOMIC_RELEASE );
+
+		memcpy( e->_key, key, GRID_PACKED_SIZE );
+		if (r._nbr_solutions > 0) {
+			Grid_pack( r._first_solution, e->_first_solution );
+		} else {
+			memset( e->_first_solution, 0, GRID_PACKED_SIZE );
+		}
+		e->_nbr_solutions = r._nbr_solutions;
+		e->_max_solutions = r._max_solutions;
+
+		__atomic_store_n( &e->_version, version + 1, __ATOMIC_RELEASE );
+	}
+
+	flock( st._map._fd, LOCK_UN );
+
+	return true;
+
+}
+
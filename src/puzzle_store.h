@@ -0,0 +1,128 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "grid.h"
+#include "result_cache.h"
+
+/**
+ * Results of the puzzles already solved kept in a file so that they
+ * can be used by the next runs and by other processes. The file is a
+ * hash table with open addressing mapped in memory, it is created the
+ * first time it is opened. It is not read when opened: only the pages
+ * of the entries looked at are loaded by the system.
+ *
+ * When three quarters of the entries are used, the writer that adds
+ * an entry copies the table into a new file with twice as many entries
+ * and renames it to the name of the store. The old file is marked as
+ * moved and the other processes map the new file the next time they
+ * look at the store. The mappings of a process are kept until the
+ * store is closed because its readers may still use them.
+ *
+ * The key of an entry is the puzzle packed in GRID_PACKED_SIZE bytes.
+ * The readers don't take any lock: the version of an entry is odd
+ * while the entry is written and a reader that finds a different
+ * version after reading the entry ignores it. The writers of the
+ * process are serialized by a mutex and the writers of different
+ * processes by a lock on the file.
+ */
+
+// number of entries of a new file, the file is sparse so only the
+// entries used take space on the disk
+const uint64_t PUZZLE_STORE_CAPACITY = 1 << 20;
+
+typedef struct PuzzleStoreHeader {
+	char _magic[ 8 ];
+	uint32_t _version;
+	uint32_t _entry_size;
+	// number of entries, a power of 2
+	uint64_t _capacity;
+	uint64_t _nbr_entries;
+	// not 0 if the table was copied to a larger file of the same name
+	uint64_t _moved;
+
+} PuzzleStoreHeader;
+
+typedef struct PuzzleStoreEntry {
+	// 0 if the entry is empty, odd while the entry is written
+	uint32_t _version;
+	uint8_t _key[ GRID_PACKED_SIZE ];
+	uint8_t _first_solution[ GRID_PACKED_SIZE ];
+	int64_t _nbr_solutions;
+	// maximum number of solutions of the search, 0 if all solutions
+	// were found
+	int64_t _max_solutions;
+
+} PuzzleStoreEntry;
+
+/**
+ * File of the store mapped in memory
+ */
+typedef struct PuzzleStoreMap {
+	int _fd;
+	size_t _size;
+	PuzzleStoreHeader *_header;
+
+} PuzzleStoreMap;
+
+typedef struct PuzzleStore {
+	std::string _name;
+	// the file can't be written, no result is added
+	bool _read_only;
+	// current file, its header is read by the readers without lock
+	PuzzleStoreMap _map;
+	std::atomic< PuzzleStoreHeader * > _header;
+	// files replaced by a larger table
+	std::vector< PuzzleStoreMap > _old_maps;
+	std::mutex _mutex;
+
+	std::atomic<uint64_t> _nbr_hits;
+	std::atomic<uint64_t> _nbr_misses;
+	// results that could not be added
+	std::atomic<uint64_t> _nbr_refused;
+
+} PuzzleStore;
+
+/**
+ * Open the store of file name, the file is created with capacity
+ * entries if it doesn't exist. The store is read only if the file
+ * can't be written. Return false if the file can't be created or is
+ * not a store.
+ */
+bool PuzzleStore_open( PuzzleStore& st, const char *name, uint64_t capacity = PUZZLE_STORE_CAPACITY );
+
+/**
+ * Write the results added to the file and close it
+ */
+void PuzzleStore_close( PuzzleStore& st );
+
+/**
+ * Find the result of puzzle g for a search limited to max_solutions
+ * (0 for all solutions), see CacheResult_get(). Return false if there
+ * is no such result.
+ */
+bool PuzzleStore_find( PuzzleStore& st, Grid& g, long max_solutions, CacheResult& r );
+
+/**
+ * Add the result of puzzle g. A result that found all solutions is
+ * not replaced. The table is grown if three quarters of its entries
+ * are used. Return false if the result could not be added because
+ * the store is read only or the table could not be grown, the result
+ * is then counted in _nbr_refused.
+ */
+bool PuzzleStore_insert( PuzzleStore& st, Grid& g, CacheResult& r );
+
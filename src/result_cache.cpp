@@ -0,0 +1,146 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include "result_cache.h"
+
+/**
+ * Key of a grid: its cells packed in GRID_PACKED_SIZE bytes
+ */
+static std::string ResultCache_key( Grid& g ) {
+
+	uint8_t bytes[ GRID_PACKED_SIZE ];
+
+	Grid_pack( g, bytes );
+
+	return std::string( reinterpret_cast<char *>( bytes ), GRID_PACKED_SIZE );
+
+}
+
+
+bool CacheResult_get( CacheResult& cached, long max_solutions, CacheResult& r ) {
+
+	// the search of the result found all solutions
+	bool complete = (cached._max_solutions == 0) or (cached._nbr_solutions < cached._max_solutions);
+
+	if (complete) {
+
+		r = cached;
+		r._max_solutions = 0;
+		if ((max_solutions > 0) and (r._nbr_solutions > max_solutions)) {
+			r._nbr_solutions = max_solutions;
+			r._max_solutions = max_solutions;
+		}
+
+	} else if ((max_solutions > 0) and (max_solutions <= cached._nbr_solutions)) {
+
+		r = cached;
+		r._nbr_solutions = max_solutions;
+		r._max_solutions = max_solutions;
+
+	} else {
+
+		return false;
+
+	}
+
+	return true;
+
+}
+
+
+void ResultCache_init( ResultCache& c, size_t capacity ) {
+
+	c._capacity = capacity;
+	c._results.clear();
+	c._index.clear();
+	c._seen.assign( RESULT_CACHE_SEEN_BITS / 64, 0 );
+	c._nbr_hits = 0;
+	c._nbr_misses = 0;
+
+}
+
+
+bool ResultCache_seen( ResultCache& c, uint64_t invariant ) {
+
+	size_t bit = invariant % RESULT_CACHE_SEEN_BITS;
+	uint64_t mask = static_cast<uint64_t>( 1 ) << (bit % 64);
+
+	std::lock_guard<std::mutex> lock( c._mutex );
+
+	if ((c._seen[ bit / 64 ] & mask) != 0) return true;
+
+	c._seen[ bit / 64 ] |= mask;
+	++c._nbr_misses;
+
+	return false;
+
+}
+
+
+bool ResultCache_find( ResultCache& c, Grid& canonical, long max_solutions, CacheResult& r ) {
+
+	std::string key = ResultCache_key( canonical );
+
+	std::lock_guard<std::mutex> lock( c._mutex );
+
+	auto it = c._index.find( key );
+
+	if (it == c._index.end()) {
+		++c._nbr_misses;
+		return false;
+	}
+
+	if (!CacheResult_get( it->second->second, max_solutions, r )) {
+		++c._nbr_misses;
+		return false;
+	}
+
+	// the result becomes the most recently used
+	c._results.splice( c._results.begin(), c._results, it->second );
+
+	++c._nbr_hits;
+
+	return true;
+
+}
+
+
+void ResultCache_insert( ResultCache& c, Grid& canonical, CacheResult& r ) {
+
+	if (c._capacity == 0) return;
+
+	std::string key = ResultCache_key( canonical );
+
+	std::lock_guard<std::mutex> lock( c._mutex );
+
+	auto it = c._index.find( key );
+
+	if (it != c._index.end()) {
+		it->second->second = r;
+		c._results.splice( c._results.begin(), c._results, it->second );
+		return;
+	}
+
+	if (c._results.size() >= c._capacity) {
+		c._index.erase( c._results.back().first );
+		c._results.pop_back();
+	}
+
+	c._results.emplace_front( key, r );
+	c._index[ key ] = c._results.begin();
+
+}
+
@@ -0,0 +1,100 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "grid.h"
+
+/**
+ * Results of the grids already solved, the key of a result is the
+ * canonical form of the grid (see canonical.h) so that a grid that
+ * is a transformation of a grid already solved is not solved again.
+ * The first solution is stored as a solution of the canonical form.
+ *
+ * The cache keeps at most _capacity results, the result used the
+ * least recently is removed first. It can be shared by several
+ * threads.
+ *
+ * Most grids of a batch are usually seen once, so a result is only
+ * added when a grid with the same invariant (see Grid_invariant())
+ * was seen before: the invariants of the grids seen are recorded in
+ * a filter of RESULT_CACHE_SEEN_BITS bits and the canonical form of
+ * a grid seen for the first time is not computed.
+ */
+
+// bits of the filter of the invariants of the grids seen
+const size_t RESULT_CACHE_SEEN_BITS = 1 << 20;
+typedef struct CacheResult {
+	long _nbr_solutions;
+	// maximum number of solutions of the search, 0 if all solutions
+	// were found
+	long _max_solutions;
+	Grid _first_solution;
+
+} CacheResult;
+
+typedef struct ResultCache {
+	size_t _capacity;
+	// results from the most recently used to the least recently used
+	std::list< std::pair< std::string, CacheResult > > _results;
+	std::unordered_map< std::string,
+		std::list< std::pair< std::string, CacheResult > >::iterator > _index;
+	// bit i is set if a grid whose invariant modulo
+	// RESULT_CACHE_SEEN_BITS is i was seen
+	std::vector< uint64_t > _seen;
+	std::mutex _mutex;
+
+	uint64_t _nbr_hits;
+	uint64_t _nbr_misses;
+
+} ResultCache;
+
+/**
+ * Get from the result of a search the result of a search limited to
+ * max_solutions (0 for all solutions). Return false if the search was
+ * stopped before max_solutions solutions were found. The maximum of r
+ * is 0 if r has all the solutions of the grid and max_solutions if
+ * the search limited to max_solutions would have been stopped.
+ */
+bool CacheResult_get( CacheResult& cached, long max_solutions, CacheResult& r );
+
+/**
+ * Initialize empty cache with its maximum number of results
+ */
+void ResultCache_init( ResultCache& c, size_t capacity );
+
+/**
+ * Return true if a grid with the given invariant may have been seen
+ * before, record the invariant and count a miss otherwise. Different
+ * invariants may share a bit of the filter, a grid is then wrongly
+ * considered as seen which only costs its canonical form.
+ */
+bool ResultCache_seen( ResultCache& c, uint64_t invariant );
+
+/**
+ * Find the result of the canonical grid for a search limited to
+ * max_solutions (0 for all solutions). A result of a search with a
+ * different limit is used if it gives the same number of solutions.
+ * Return false if there is no such result.
+ */
+bool ResultCache_find( ResultCache& c, Grid& canonical, long max_solutions, CacheResult& r );
+
+/**
+ * Add or replace the result of the canonical grid
+ */
+void ResultCache_insert( ResultCache& c, Grid& canonical, CacheResult& r );
+
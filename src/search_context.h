@@ -0,0 +1,168 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include "grid.h"
+#include "solution_writer.h"
+#include "search_stats.h"
+
+/**
+ * Maximum number of solutions of a grid shared by the threads that
+ * solve it. The flag is set when the maximum is reached and the
+ * threads stop their search as soon as they see it.
+ */
+typedef struct SearchLimit {
+	long _max_solutions;
+	std::atomic<long> _nbr_solutions;
+	std::atomic<bool> _stop;
+	// set when a search gives up a part of its tree because of the
+	// limit, the search of the grid is then not complete
+	std::atomic<bool> _cut;
+
+} SearchLimit;
+
+/**
+ * Initialize limit with the maximum number of solutions (at least 1)
+ */
+inline void SearchLimit_init( SearchLimit& l, long max_solutions ) {
+	l._max_solutions = max_solutions;
+	l._nbr_solutions = 0;
+	l._stop = false;
+	l._cut = false;
+}
+
+/**
+ * Return true if the limit is reached
+ */
+inline bool SearchLimit_stop( SearchLimit& l ) {
+	return l._stop.load( std::memory_order_relaxed );
+}
+
+/**
+ * Return true if the limit is reached, called by a search before it
+ * explores a part of its tree which is then recorded as cut
+ */
+inline bool SearchLimit_cut( SearchLimit& l ) {
+
+	if (!SearchLimit_stop( l )) return false;
+
+	l._cut.store( true, std::memory_order_relaxed );
+
+	return true;
+
+}
+
+/**
+ * Count a new solution, return false if the solution is beyond the
+ * limit and must be ignored
+ */
+inline bool SearchLimit_add_solution( SearchLimit& l ) {
+
+	long n = ++l._nbr_solutions;
+
+	if (n >= l._max_solutions) l._stop.store( true, std::memory_order_relaxed );
+
+	return n <= l._max_solutions;
+
+}
+
+/**
+ * Results of the search of one grid. The search functions record
+ * the solutions in the context they are given instead of global
+ * variables so that several grids can be solved at the same time
+ * by different threads.
+ */
+typedef struct SearchContext {
+	long _nbr_solutions;
+	// null if the number of solutions is not limited
+	SearchLimit *_limit;
+	Grid _first_solution;
+
+} SearchContext;
+
+/**
+ * Initialize context before the search of a new grid
+ */
+inline void SearchContext_init( SearchContext& ctx, SearchLimit *limit = nullptr ) {
+	ctx._nbr_solutions = 0;
+	ctx._limit = limit;
+}
+
+/**
+ * Return true if the search must stop because the maximum number
+ * of solutions was found, it must only be called when there is a
+ * part of the tree left to explore (see SearchLimit_cut())
+ */
+inline bool SearchContext_stop( SearchContext& ctx ) {
+	return (ctx._limit != nullptr) and SearchLimit_cut( *ctx._limit );
+}
+
+/**
+ * Record solution g, return true if it is the first one. When the
+ * number of solutions is limited, the solutions found by the threads
+ * after the maximum is reached are not recorded.
+ */
+inline bool SearchContext_add_solution( SearchContext& ctx, Grid& g ) {
+
+	if ((ctx._limit != nullptr) and !SearchLimit_add_solution( *ctx._limit )) {
+		return false;
+	}
+
+	if (ctx._nbr_solutions++ != 0) return false;
+
+	Grid_copy( ctx._first_solution, g );
+
+	return true;
+
+}
+
+/**
+ * Context of a thread of the parallel searches with the buffer where
+ * it writes its solutions and the statistics of its search. It is
+ * padded with a cache line so that the counters of two threads are
+ * not on the same line.
+ */
+typedef struct ThreadContext {
+	SearchContext _ctx;
+	SolutionBuffer _buffer;
+	SearchStats _stats;
+
+	char _padding[ 64 ];
+
+} ThreadContext;
+
+/**
+ * Merge the contexts of the threads: the number of solutions is the
+ * sum of the solutions of the threads and the first solution is the
+ * one of the first thread that found a solution
+ */
+inline void SearchContext_reduce( SearchContext& ctx, ThreadContext *contexts,
+		int nbr_threads ) {
+
+	SearchContext_init( ctx );
+
+	for (int t = 0; t < nbr_threads; ++t) {
+
+		SearchContext& tc = contexts[ t ]._ctx;
+
+		if ((ctx._nbr_solutions == 0) and (tc._nbr_solutions != 0)) {
+			Grid_copy( ctx._first_solution, tc._first_solution );
+		}
+
+		ctx._nbr_solutions += tc._nbr_solutions;
+	}
+
+}
+
@@ -0,0 +1,284 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include <iomanip>
+#include <sstream>
+#include <ctime>
+#include <omp.h>
+#include "search_stats.h"
+
+using namespace std;
+
+// count the hardware events
+static bool perf_flag = false;
+
+#if SEARCH_STATS
+/**
+ * Return CPU time of the calling thread in seconds
+ */
+static double SearchStats_cpu_time() {
+
+	struct timespec ts;
+
+	clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts );
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+
+}
+#endif
+
+/**
+ * Sum of the statistics of the threads
+ */
+static void SearchStats_sum( SearchStats& total, vector< SearchStats * >& stats ) {
+
+	SearchStats_init( total );
+
+	for (SearchStats *st : stats) {
+
+		total._nbr_nodes += st->_nbr_nodes;
+		total._nbr_checks += st->_nbr_checks;
+		total._nbr_backtracks += st->_nbr_backtracks;
+
+		for (int d = 0; d < STATS_MAX_DEPTH; ++d) {
+			total._depth_nodes[ d ] += st->_depth_nodes[ d ];
+			total._depth_branches[ d ] += st->_depth_branches[ d ];
+		}
+
+		total._nbr_seeds += st->_nbr_seeds;
+
+		for (int b = 0; b < STATS_SEED_BUCKETS; ++b) {
+			total._seed_solutions[ b ] += st->_seed_solutions[ b ];
+		}
+
+		total._wall_time += st->_wall_time;
+		total._cpu_time += st->_cpu_time;
+
+		PerfCounters_add( total._perf, st->_perf );
+	}
+
+}
+
+/**
+ * Smallest and greatest number of solutions of bucket b
+ */
+static void SearchStats_bucket( int b, uint64_t& min, uint64_t& max ) {
+
+	min = (b == 0) ? 0 : (1ULL << (b - 1));
+	max = (b == 0) ? 0 : (1ULL << b) - 1;
+
+}
+
+
+void SearchStats_use_perf( bool flag ) {
+
+	perf_flag = flag;
+
+}
+
+
+void SearchStats_start( SearchStats& st ) {
+
+#if SEARCH_STATS
+	if (perf_flag) PerfCounters_start( st._perf );
+	st._wall_start = omp_get_wtime();
+	st._cpu_start = SearchStats_cpu_time();
+#endif
+
+}
+
+
+void SearchStats_stop( SearchStats& st ) {
+
+#if SEARCH_STATS
+	st._wall_time += omp_get_wtime() - st._wall_start;
+	st._cpu_time += SearchStats_cpu_time() - st._cpu_start;
+	if (perf_flag) PerfCounters_stop( st._perf );
+#endif
+
+}
+
+/**
+ * Print one line of the counters of a thread
+ */
+static void SearchStats_print_thread( ostream& out, SearchStats& st ) {
+
+	out << setw( 14 ) << st._nbr_nodes << setw( 14 ) << st._nbr_checks
+		<< setw( 12 ) << st._nbr_backtracks << setw( 10 ) << st._nbr_seeds
+		<< fixed << setprecision( 3 ) << setw( 10 ) << st._wall_time
+		<< setw( 10 ) << st._cpu_time << endl;
+
+}
+
+
+void SearchStats_print( ostream& out, vector< SearchStats * >& stats ) {
+
+	SearchStats total;
+	SearchStats_sum( total, stats );
+
+	out << "- search statistics" << endl;
+	out << "  thread         nodes        checks  backtracks     seeds   wall(s)    cpu(s)" << endl;
+
+	for (size_t t = 0; t < stats.size(); ++t) {
+		out << setw( 8 ) << t;
+		SearchStats_print_thread( out, *stats[ t ] );
+	}
+
+	if (stats.size() > 1) {
+		out << "   total";
+		SearchStats_print_thread( out, total );
+	}
+
+	if (perf_flag) {
+
+		out << endl;
+
+		if (!PerfCounters_available( total._perf )) {
+
+			out << "- hardware counters not available" << endl;
+
+		} else {
+
+			out << "- hardware counters" << endl;
+			out << "  thread";
+			PerfCounters_print_header( out );
+			out << endl;
+
+			for (size_t t = 0; t < stats.size(); ++t) {
+				out << setw( 8 ) << t;
+				PerfCounters_print( out, stats[ t ]->_perf );
+				out << endl;
+			}
+
+			if (stats.size() > 1) {
+				out << "   total";
+				PerfCounters_print( out, total._perf );
+				out << endl;
+			}
+		}
+	}
+
+	out << endl;
+	out << "- branching by depth" << endl;
+	out << "   depth         nodes      branches  branching" << endl;
+
+	for (int d = 0; d < STATS_MAX_DEPTH; ++d) {
+
+		if (total._depth_nodes[ d ] == 0) continue;
+
+		out << setw( 8 ) << d << setw( 14 ) << total._depth_nodes[ d ]
+			<< setw( 14 ) << total._depth_branches[ d ]
+			<< fixed << setprecision( 2 ) << setw( 11 )
+			<< static_cast<double>( total._depth_branches[ d ] ) / total._depth_nodes[ d ] << endl;
+	}
+
+	if (total._nbr_seeds == 0) return;
+
+	out << endl;
+	out << "- solutions of the seed grids" << endl;
+	out << "           solutions     seeds" << endl;
+
+	for (int b = 0; b < STATS_SEED_BUCKETS; ++b) {
+
+		if (total._seed_solutions[ b ] == 0) continue;
+
+		uint64_t min, max;
+		SearchStats_bucket( b, min, max );
+
+		ostringstream range;
+		range << min;
+		if (max != min) range << "-" << max;
+
+		out << setw( 20 ) << range.str() << setw( 10 ) << total._seed_solutions[ b ] << endl;
+	}
+
+}
+
+/**
+ * Print the counters of a thread as the members of a JSON object
+ */
+static void SearchStats_print_thread_json( ostream& out, SearchStats& st ) {
+
+	out << "\"nodes\": " << st._nbr_nodes << ", \"checks\": " << st._nbr_checks
+		<< ", \"backtracks\": " << st._nbr_backtracks << ", \"seeds\": " << st._nbr_seeds
+		<< fixed << setprecision( 6 ) << ", \"wall_time\": " << st._wall_time
+		<< ", \"cpu_time\": " << st._cpu_time;
+
+	if (perf_flag) {
+		out << ", \"perf\": { ";
+		PerfCounters_print_json( out, st._perf );
+		out << " }";
+	}
+
+}
+
+
+void SearchStats_print_json( ostream& out, vector< SearchStats * >& stats ) {
+
+	SearchStats total;
+	SearchStats_sum( total, stats );
+
+	out << "{" << endl;
+	out << "  \"threads\": [" << endl;
+
+	for (size_t t = 0; t < stats.size(); ++t) {
+		out << "    { \"thread\": " << t << ", ";
+		SearchStats_print_thread_json( out, *stats[ t ] );
+		out << " }" << ((t + 1 < stats.size()) ? "," : "") << endl;
+	}
+
+	out << "  ]," << endl;
+	out << "  \"total\": { ";
+	SearchStats_print_thread_json( out, total );
+	out << " }," << endl;
+
+	out << "  \"depths\": [";
+
+	bool first = true;
+
+	for (int d = 0; d < STATS_MAX_DEPTH; ++d) {
+
+		if (total._depth_nodes[ d ] == 0) continue;
+
+		out << (first ? "" : ",") << endl;
+		out << "    { \"depth\": " << d << ", \"nodes\": " << total._depth_nodes[ d ]
+			<< ", \"branches\": " << total._depth_branches[ d ] << " }";
+		first = false;
+	}
+
+	out << endl << "  ]," << endl;
+	out << "  \"seed_solutions\": [";
+
+	first = true;
+
+	for (int b = 0; b < STATS_SEED_BUCKETS; ++b) {
+
+		if (total._seed_solutions[ b ] == 0) continue;
+
+		uint64_t min, max;
+		SearchStats_bucket( b, min, max );
+
+		out << (first ? "" : ",") << endl;
+		out << "    { \"min\": " << min << ", \"max\": " << max
+			<< ", \"seeds\": " << total._seed_solutions[ b ] << " }";
+		first = false;
+	}
+
+	out << endl << "  ]" << endl;
+	out << "}" << endl;
+
+}
+
@@ -0,0 +1,145 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <ostream>
+#include <vector>
+#include <cstring>
+#include "grid.h"
+#include "perf_counters.h"
+
+/**
+ * Statistics of the search gathered by each thread in its own
+ * counters. They are only gathered if the program is compiled with
+ * SEARCH_STATS set to 1 (make STATS=1), otherwise the functions that
+ * update them are empty and the searches are not slowed down.
+ *
+ * - a node is a position where values are tried, its depth is the
+ *   index of the position in the order of the search
+ * - a check tests if a value can be placed at a position or computes
+ *   the values allowed at a position
+ * - a branch is a value placed at a node
+ * - a backtrack is a node where no value can be placed or where the
+ *   propagation of a value fails
+ */
+#ifndef SEARCH_STATS
+#define SEARCH_STATS 0
+#endif
+
+// one depth for each empty position
+const int STATS_MAX_DEPTH = GRID_NBR_CELLS + 1;
+
+// buckets of the solutions of a seed grid: 0, 1, 2-3, 4-7, ...
+const int STATS_SEED_BUCKETS = 32;
+
+typedef struct SearchStats {
+	uint64_t _nbr_nodes;
+	uint64_t _nbr_checks;
+	uint64_t _nbr_backtracks;
+	// nodes and branches at each depth
+	uint64_t _depth_nodes[ STATS_MAX_DEPTH ];
+	uint64_t _depth_branches[ STATS_MAX_DEPTH ];
+
+	// seed grids solved by the thread and number of seed grids in
+	// each bucket of solutions
+	uint64_t _nbr_seeds;
+	uint64_t _seed_solutions[ STATS_SEED_BUCKETS ];
+
+	// time of the thread in seconds
+	double _wall_time;
+	double _cpu_time;
+	double _wall_start;
+	double _cpu_start;
+
+	// hardware counters of the thread, see SearchStats_use_perf()
+	PerfCounters _perf;
+
+} SearchStats;
+
+/**
+ * Reset all counters
+ */
+inline void SearchStats_init( SearchStats& st ) {
+	memset( &st, 0, sizeof( SearchStats ) );
+	PerfCounters_init( st._perf );
+}
+
+inline void SearchStats_node( SearchStats& st, int depth ) {
+#if SEARCH_STATS
+	++st._nbr_nodes;
+	++st._depth_nodes[ depth ];
+#endif
+}
+
+inline void SearchStats_branch( SearchStats& st, int depth ) {
+#if SEARCH_STATS
+	++st._depth_branches[ depth ];
+#endif
+}
+
+inline void SearchStats_check( SearchStats& st ) {
+#if SEARCH_STATS
+	++st._nbr_checks;
+#endif
+}
+
+inline void SearchStats_backtrack( SearchStats& st ) {
+#if SEARCH_STATS
+	++st._nbr_backtracks;
+#endif
+}
+
+/**
+ * Add the nodes of a search that doesn't record their depth
+ */
+inline void SearchStats_add_nodes( SearchStats& st, uint64_t nbr_nodes ) {
+#if SEARCH_STATS
+	st._nbr_nodes += nbr_nodes;
+#endif
+}
+
+/**
+ * Record a seed grid that has nbr_solutions solutions
+ */
+inline void SearchStats_seed( SearchStats& st, long nbr_solutions ) {
+#if SEARCH_STATS
+	int bucket = 0;
+	while ((nbr_solutions > 0) and (bucket < STATS_SEED_BUCKETS - 1)) {
+		nbr_solutions >>= 1;
+		++bucket;
+	}
+	++st._nbr_seeds;
+	++st._seed_solutions[ bucket ];
+#endif
+}
+
+/**
+ * Also count the hardware events of the threads between
+ * SearchStats_start() and SearchStats_stop() (see perf_counters.h)
+ */
+void SearchStats_use_perf( bool flag );
+
+/**
+ * Start and stop the clocks of the thread that calls the functions,
+ * the times are added to the time of the thread
+ */
+void SearchStats_start( SearchStats& st );
+void SearchStats_stop( SearchStats& st );
+
+/**
+ * Print the statistics of the threads and their sum in a human
+ * readable form or in JSON
+ */
+void SearchStats_print( std::ostream& out, std::vector< SearchStats * >& stats );
+void SearchStats_print_json( std::ostream& out, std::vector< SearchStats * >& stats );
+
@@ -0,0 +1,180 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include <algorithm>
+#include "seed_generator.h"
+
+void SeedGenerator_init( SeedGenerator& sg, Grid& g,
+		vector< BlockCost >& blocks_costs, int nbr_blocks ) {
+
+	Grid_copy( sg._grid, g );
+
+	sg._nbr_cells = 0;
+	sg._depth = 0;
+	sg._started = false;
+	sg._nbr_seeds = 0;
+
+	// the initial grid can violate the constraints
+	sg._finished = (GridState_init( sg._state, sg._grid ) == UNSATISFIED);
+
+	int n = std::min( nbr_blocks, static_cast<int>( blocks_costs.size() ) );
+
+	for (int i = 0; i < n; ++i) {
+
+		const uint8_t *cells = grid_tables._blk_cells[ blocks_costs[ i ]._block ];
+
+		for (int k = 0; k < MAX_VAL; ++k) {
+			if (Grid_get_cell( g, cells[ k ] ) == ZERO) {
+				Position& p = sg._cells[ sg._nbr_cells++ ];
+				p._y = grid_tables._row[ cells[ k ] ];
+				p._x = grid_tables._col[ cells[ k ] ];
+			}
+		}
+	}
+
+}
+
+
+bool SeedGenerator_next( SeedGenerator& sg, Grid& seed ) {
+
+	std::lock_guard<std::mutex> lock( sg._mutex );
+
+	if (sg._finished) return false;
+
+	int m = sg._nbr_cells;
+
+	// no cell to fill: the initial grid is the only seed
+	if (m == 0) {
+		Grid_copy( seed, sg._grid );
+		sg._finished = true;
+		++sg._nbr_seeds;
+		return true;
+	}
+
+	// resume from the last seed generated
+	bool forward = !sg._started;
+	int i = sg._started ? m - 1 : 0;
+	sg._started = true;
+
+	while (i >= 0) {
+
+		int y = sg._cells[ i ]._y;
+		int x = sg._cells[ i ]._x;
+		int b = Grid_block_of( y, x );
+		GridElementType v = ZERO;
+
+		if (!forward) {
+			v = Grid_get( sg._grid, y, x );
+			GridState_remove( sg._state, y, x, b, v );
+		}
+
+		++v;
+		while ((v <= MAX_VAL) and !GridState_can_place( sg._state, y, x, b, v )) {
+			++v;
+		}
+
+		if (v > MAX_VAL) {
+			Grid_set( sg._grid, y, x, ZERO );
+			--i;
+			forward = false;
+			continue;
+		}
+
+		Grid_set( sg._grid, y, x, v );
+		GridState_place( sg._state, y, x, b, v );
+		++i;
+		forward = true;
+
+		if (i == m) {
+			Grid_copy( seed, sg._grid );
+			++sg._nbr_seeds;
+			return true;
+		}
+	}
+
+	sg._finished = true;
+
+	return false;
+
+}
+
+
+void SeedGenerator_empty_positions( SeedGenerator& sg, vector< Position >& positions ) {
+
+	Grid g;
+	Grid_copy( g, sg._grid );
+
+	// the cells filled by the generator are not empty in the seeds
+	for (int i = 0; i < sg._nbr_cells; ++i) {
+		Grid_set( g, sg._cells[ i ]._y, sg._cells[ i ]._x, MAX_VAL );
+	}
+
+	Grid_find_empty_positions( g, positions );
+
+}
+
+
+int SeedGenerator_select_blocks( Grid& g, vector< BlockCost >& blocks_costs, uint64_t nbr_seeds ) {
+
+	uint64_t max_seeds = nbr_seeds * SEEDS_MAX_FACTOR;
+
+	int nbr_empty = 0;
+	for (int c = 0; c < GRID_NBR_CELLS; ++c) {
+		if (Grid_get_cell( g, c ) == ZERO) ++nbr_empty;
+	}
+
+	SeedGenerator *generator = new SeedGenerator;
+	Grid seed;
+
+	int nbr_blocks = 1;
+	// upper bound of the number of seeds
+	uint64_t permutations = 1;
+
+	for (int k = 1; k <= static_cast<int>( blocks_costs.size() ); ++k) {
+
+		int missing = static_cast<int>( blocks_costs[ k - 1 ]._values.size() );
+
+		nbr_empty -= missing;
+		if ((k > 1) and (nbr_empty < SEEDS_MIN_EMPTY_CELLS)) break;
+
+		for (int i = 2; (i <= missing) and (permutations <= max_seeds); ++i) {
+			permutations *= i;
+		}
+
+		if (permutations <= nbr_seeds) {
+			nbr_blocks = k;
+			continue;
+		}
+
+		SeedGenerator_init( *generator, g, blocks_costs, k );
+
+		uint64_t n = 0;
+		while ((n <= max_seeds) and SeedGenerator_next( *generator, seed )) {
+			++n;
+		}
+
+		if ((k > 1) and (n > max_seeds)) break;
+
+		nbr_blocks = k;
+		if (n >= nbr_seeds) break;
+	}
+
+	delete generator;
+
+	return nbr_blocks;
+
+}
+
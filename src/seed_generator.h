@@ -0,0 +1,95 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <mutex>
+#include "grid.h"
+#include "grid_state.h"
+
+/**
+ * Generator of the seed grids of the parallel implementations.
+ *
+ * Instead of creating all the permutations of the missing values
+ * of the first blocks, the generator fills the empty cells of these
+ * blocks one after the other and checks the row, column and block
+ * constraints for each value. It only yields the grids that are
+ * consistent, one at a time, so that the memory used doesn't depend
+ * on the number of blocks.
+ *
+ * SeedGenerator_next() can be called by several threads at the
+ * same time.
+ */
+typedef struct SeedGenerator {
+	// current assignment of the cells and its constraints
+	Grid _grid;
+	GridState _state;
+
+	// empty cells of the blocks to fill
+	Position _cells[ MAX_VAL * MAX_VAL ];
+	int _nbr_cells;
+
+	// index of the cell to fill next
+	int _depth;
+	bool _started;
+	bool _finished;
+
+	// number of seeds generated
+	uint64_t _nbr_seeds;
+
+	std::mutex _mutex;
+
+} SeedGenerator;
+
+/**
+ * Initialize generator to fill the empty cells of the first
+ * 'nbr_blocks' blocks of 'blocks_costs' of the grid g
+ */
+void SeedGenerator_init( SeedGenerator& sg, Grid& g,
+	vector< BlockCost >& blocks_costs, int nbr_blocks );
+
+/**
+ * Copy next consistent seed grid into 'seed'. Return false if
+ * there is no seed left.
+ */
+bool SeedGenerator_next( SeedGenerator& sg, Grid& seed );
+
+/**
+ * Find positions that remain empty in the seed grids
+ */
+void SeedGenerator_empty_positions( SeedGenerator& sg, vector< Position >& positions );
+
+// seed grids wanted for each thread by SeedGenerator_select_blocks()
+const int SEEDS_PER_THREAD = 16;
+// the number of seed grids may exceed the number wanted by this factor
+const int SEEDS_MAX_FACTOR = 64;
+// a seed grid with fewer empty cells is solved too fast to be worth
+// a task
+const int SEEDS_MIN_EMPTY_CELLS = 16;
+
+/**
+ * Select the number of blocks of 'blocks_costs' whose permutations
+ * give about 'nbr_seeds' seed grids, used instead of a fixed number
+ * of blocks (--auto-split). Blocks are added while there are fewer
+ * seeds than wanted:
+ * - the product of the permutations of the blocks is an upper bound
+ *   of the number of seeds, the seeds are only counted with the
+ *   generator when it is greater than nbr_seeds
+ * - a block is not added if the seeds would have more than
+ *   SEEDS_MAX_FACTOR times the seeds wanted or fewer than
+ *   SEEDS_MIN_EMPTY_CELLS empty cells, the size of their searches
+ *
+ * Return a number of blocks in [1..blocks_costs.size()], or 1 if
+ * there is no block to fill.
+ */
+int SeedGenerator_select_blocks( Grid& g, vector< BlockCost >& blocks_costs, uint64_t nbr_seeds );
+
@@ -0,0 +1,197 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include "solution_writer.h"
+
+// size of the blocks given to the writer
+const size_t SOLUTION_BLOCK_SIZE = 256 * 1024;
+// maximum number of blocks waiting to be written
+const size_t SOLUTION_MAX_BLOCKS = 64;
+
+/**
+ * Write all bytes of a block, return false if the write failed
+ */
+static bool SolutionWriter_write( SolutionWriter& w, std::vector<char>& block ) {
+
+	const char *p = block.data();
+	size_t size = block.size();
+
+	while (size > 0) {
+
+		ssize_t n = write( w._fd, p, size );
+
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+
+		p += n;
+		size -= n;
+	}
+
+	w._nbr_bytes += block.size();
+
+	return true;
+
+}
+
+/**
+ * Thread of the writer that writes the blocks until the writer is
+ * closed
+ */
+static void SolutionWriter_run( SolutionWriter& w ) {
+
+	std::vector<char> block;
+
+	while (true) {
+
+		{
+			std::unique_lock<std::mutex> lock( w._mutex );
+
+			while (w._blocks.empty() and !w._closed) {
+				w._not_empty.wait( lock );
+			}
+
+			if (w._blocks.empty()) return;
+
+			block.swap( w._blocks.front() );
+			w._blocks.pop_front();
+		}
+
+		w._not_full.notify_one();
+
+		if (!w._error and !SolutionWriter_write( w, block )) {
+			// the solutions are still consumed so that the threads
+			// of the search are not blocked
+			w._error = true;
+		}
+
+		block.clear();
+	}
+
+}
+
+
+bool SolutionWriter_open( SolutionWriter& w, const char *file_name, int format ) {
+
+	w._format = format;
+	w._solution_size = (format == SOLUTION_FORMAT_PACKED) ? GRID_PACKED_SIZE : GRID_NBR_CELLS + 1;
+	w._closed = false;
+	w._error = false;
+	w._nbr_bytes = 0;
+	w._blocks.clear();
+
+	if (strcmp( file_name, "-" ) == 0) {
+		// the messages already printed must be written before the
+		// solutions
+		cout.flush();
+		w._fd = STDOUT_FILENO;
+		w._close_fd = false;
+	} else {
+		w._fd = open( file_name, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+		w._close_fd = true;
+		if (w._fd < 0) return false;
+	}
+
+	w._thread = std::thread( SolutionWriter_run, std::ref( w ) );
+
+	return true;
+
+}
+
+
+bool SolutionWriter_close( SolutionWriter& w ) {
+
+	{
+		std::lock_guard<std::mutex> lock( w._mutex );
+		w._closed = true;
+	}
+
+	w._not_empty.notify_all();
+
+	w._thread.join();
+
+	if (w._close_fd and (close( w._fd ) < 0)) w._error = true;
+
+	return !w._error;
+
+}
+
+
+void SolutionBuffer_init( SolutionBuffer& b, SolutionWriter *w ) {
+
+	b._writer = w;
+	b._data.clear();
+
+	if (w != nullptr) b._data.reserve( SOLUTION_BLOCK_SIZE + w->_solution_size );
+
+}
+
+
+void SolutionBuffer_flush( SolutionBuffer& b ) {
+
+	if (b._data.empty()) return;
+
+	SolutionWriter& w = *b._writer;
+
+	{
+		std::unique_lock<std::mutex> lock( w._mutex );
+
+		while (w._blocks.size() >= SOLUTION_MAX_BLOCKS) {
+			w._not_full.wait( lock );
+		}
+
+		w._blocks.push_back( std::vector<char>() );
+		w._blocks.back().swap( b._data );
+	}
+
+	w._not_empty.notify_one();
+
+	b._data.reserve( SOLUTION_BLOCK_SIZE + w._solution_size );
+
+}
+
+
+void SolutionBuffer_add( SolutionBuffer& b, Grid& g ) {
+
+	size_t size = b._data.size();
+
+	b._data.resize( size + b._writer->_solution_size );
+
+	char *p = &b._data[ size ];
+
+	if (b._writer->_format == SOLUTION_FORMAT_PACKED) {
+
+		Grid_pack( g, reinterpret_cast<uint8_t *>( p ) );
+
+	} else {
+
+		for (int y = MIN_VAL; y <= MAX_VAL; ++y) {
+			for (int x = MIN_VAL; x <= MAX_VAL; ++x) {
+				*p++ = static_cast<char>( '0' + Grid_get( g, y, x ) );
+			}
+		}
+		*p = '\n';
+
+	}
+
+	if (b._data.size() >= SOLUTION_BLOCK_SIZE) SolutionBuffer_flush( b );
+
+}
+
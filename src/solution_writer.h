@@ -0,0 +1,91 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+#include "grid.h"
+
+/**
+ * Output of all the solutions of a search.
+ *
+ * Each search thread formats its solutions in its own SolutionBuffer
+ * without any lock. When a buffer is full its block of bytes is given
+ * to the SolutionWriter whose thread writes the blocks to the file
+ * with one system call per block.
+ *
+ * Two formats are available:
+ * - SOLUTION_FORMAT_TEXT: 81 characters and a '\n' per solution
+ * - SOLUTION_FORMAT_PACKED: GRID_PACKED_SIZE (41) bytes per solution
+ *   written by Grid_pack()
+ */
+const int SOLUTION_FORMAT_TEXT = 0;
+const int SOLUTION_FORMAT_PACKED = 1;
+
+typedef struct SolutionWriter {
+	int _fd;
+	bool _close_fd;
+	int _format;
+	// number of bytes written for one solution
+	int _solution_size;
+	// blocks waiting to be written
+	std::deque< std::vector<char> > _blocks;
+	std::mutex _mutex;
+	std::condition_variable _not_empty;
+	std::condition_variable _not_full;
+	bool _closed;
+	bool _error;
+	uint64_t _nbr_bytes;
+	std::thread _thread;
+
+} SolutionWriter;
+
+/**
+ * Buffer of the solutions of one thread
+ */
+typedef struct SolutionBuffer {
+	SolutionWriter *_writer;
+	std::vector<char> _data;
+
+} SolutionBuffer;
+
+/**
+ * Open file_name ("-" for the standard output) and start the thread
+ * of the writer, return false if the file can't be created
+ */
+bool SolutionWriter_open( SolutionWriter& w, const char *file_name, int format );
+
+/**
+ * Write the blocks that remain, stop the thread and close the file,
+ * return false if a write failed. The buffers must be flushed before.
+ */
+bool SolutionWriter_close( SolutionWriter& w );
+
+/**
+ * Initialize buffer of a thread for writer w
+ */
+void SolutionBuffer_init( SolutionBuffer& b, SolutionWriter *w );
+
+/**
+ * Give the solutions of the buffer to the writer
+ */
+void SolutionBuffer_flush( SolutionBuffer& b );
+
+/**
+ * Add solution g to the buffer, the buffer is flushed when full
+ */
+void SolutionBuffer_add( SolutionBuffer& b, Grid& g );
+
@@ -0,0 +1,1102 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+#include "solver.h"
+#include "seed_generator.h"
+#include "frontier.h"
+#include "work_stealing.h"
+#include "canonical.h"
+#include "solver_n.h"
+
+void SolverOptions_init( SolverOptions& o ) {
+
+	o._engine = SOLVER_RECURSIVE;
+	o._mrv = false;
+	o._propagate = false;
+	o._reverse = false;
+
+	o._parallel = false;
+	o._nbr_threads = 0;
+	o._nbr_blocks = 1;
+	o._frontier = 0;
+	o._work_stealing = false;
+	o._task_depth = 0;
+
+	o._max_solutions = 0;
+
+	o._cache = nullptr;
+	o._store = nullptr;
+	o._writer = nullptr;
+	o._callback = nullptr;
+	o._data = nullptr;
+
+}
+
+
+void Solver_init( Solver& s, SolverOptions& o ) {
+
+	s._options = o;
+
+	if (!o._parallel) {
+		s._nbr_threads = 1;
+	} else if (o._nbr_threads > 0) {
+		s._nbr_threads = o._nbr_threads;
+	} else {
+		s._nbr_threads = omp_get_max_threads();
+	}
+
+	s._contexts = new ThreadContext[ s._nbr_threads ];
+
+	for (int t = 0; t < s._nbr_threads; ++t) {
+		SearchContext_init( s._contexts[ t ]._ctx );
+		SolutionBuffer_init( s._contexts[ t ]._buffer, o._writer );
+	}
+
+	s._dlx = nullptr;
+
+}
+
+
+void Solver_free( Solver& s ) {
+
+	delete [] s._contexts;
+	s._contexts = nullptr;
+
+	delete s._dlx;
+	s._dlx = nullptr;
+
+}
+
+
+void Solver_blocks_costs( Grid& g, vector< BlockCost >& blocks_costs ) {
+
+	blocks_costs.clear();
+
+	for (int block = MIN_VAL; block <= MAX_VAL; ++block) {
+		BlockCost bc;
+		bc._block = block;
+		bc._permutations = 0;
+		bc._cost = Grid_block_nbr_values_set( g, block, bc._values );
+
+		if (Grid_blk_satisfied( g, block ) != SATISFIED) {
+			blocks_costs.push_back( bc );
+		}
+	}
+
+	// sort by most constrained block
+	std::sort( blocks_costs.begin(), blocks_costs.end(), []( const BlockCost& a, const BlockCost& b) {
+		return a._cost > b._cost;
+	} );
+
+}
+
+/**
+ * Record solution g found by the thread of context tc. A solution
+ * found after the maximum number of solutions is reached is ignored.
+ */
+static void Solver_record( Solver& s, int thread, Grid& g ) {
+
+	ThreadContext& tc = s._contexts[ thread ];
+
+	long n = tc._ctx._nbr_solutions;
+
+	SearchContext_add_solution( tc._ctx, g );
+
+	if (tc._ctx._nbr_solutions == n) return;
+
+	if (tc._buffer._writer != nullptr) SolutionBuffer_add( tc._buffer, g );
+
+	if (s._options._callback != nullptr) s._options._callback( g, thread, s._options._data );
+
+}
+
+// ==================================================================
+// SEQUENTIAL SEARCHES
+// ==================================================================
+
+/**
+ * Recursively solve the Sudoku given the list of zero positions.
+ * The state of the constraints is updated each time a value is
+ * placed or removed so that we only need to check the row, column
+ * and block of the position instead of the whole grid.
+ *
+ * If the propagation is used, the positions set by the propagation
+ * are skipped and all positions set after a value is placed are
+ * recorded in the trail in order to be reset.
+ */
+static void Solver_recursive( Solver& s, Grid& g, GridState& state, int n = 0 ) {
+
+	SearchContext& ctx = s._contexts[ 0 ]._ctx;
+	SearchStats& st = s._contexts[ 0 ]._stats;
+
+	if (SearchContext_stop( ctx )) return;
+
+	vector< PositionCost >& epc = s._positions;
+	Trail& t = s._trail;
+
+	int m = static_cast<int>( epc.size() );
+
+	while ((n < m) and (Grid_get( g, epc[ n ]._y, epc[ n ]._x ) != ZERO)) {
+		++n;
+	}
+
+	if (n == m) {
+
+		if (GridState_satisfied( state ) == SATISFIED) {
+			Solver_record( s, 0, g );
+		}
+
+	} else {
+
+		PositionCost pc = epc[ n ];
+		int b = Grid_block_of( pc._y, pc._x );
+		int branches = 0;
+
+		SearchStats_node( st, n );
+
+		for (GridElementType v = MIN_VAL; v <= MAX_VAL; ++v ) {
+
+			SearchStats_check( st );
+
+			if (GridState_can_place( state, pc._y, pc._x, b, v )) {
+
+				int mark = t._size;
+
+				Grid_assign( g, state, t, pc._y, pc._x, v );
+				SearchStats_branch( st, n );
+				++branches;
+
+				if (!s._options._propagate or Grid_propagate( g, state, t )) {
+
+					Solver_recursive( s, g, state, n + 1 );
+
+				} else {
+
+					SearchStats_backtrack( st );
+
+				}
+
+				Trail_undo( g, state, t, mark );
+
+			}
+
+		}
+
+		if (branches == 0) SearchStats_backtrack( st );
+	}
+
+}
+
+/**
+ * Recursively solve the Sudoku by choosing at each node the empty
+ * position with the minimum number of values allowed (Minimum
+ * Remaining Values) instead of following a static order.
+ */
+static void Solver_recursive_mrv( Solver& s, Grid& g, GridState& state, int d = 0 ) {
+
+	SearchContext& ctx = s._contexts[ 0 ]._ctx;
+	SearchStats& st = s._contexts[ 0 ]._stats;
+
+	if (SearchContext_stop( ctx )) return;
+
+	Trail& t = s._trail;
+
+	int y, x;
+	int count = GridState_select_mrv( state, y, x );
+
+	if (count < 0) {
+
+		if (GridState_satisfied( state ) == SATISFIED) {
+			Solver_record( s, 0, g );
+		}
+
+	} else {
+
+		GridMask candidates = GridState_candidates( state, y, x, Grid_block_of( y, x ) );
+
+		SearchStats_node( st, d );
+		SearchStats_check( st );
+		if (candidates == 0) SearchStats_backtrack( st );
+
+		while (candidates != 0) {
+
+			GridElementType v = __builtin_ctz( candidates );
+			candidates &= candidates - 1;
+
+			int mark = t._size;
+
+			Grid_assign( g, state, t, y, x, v );
+			SearchStats_branch( st, d );
+
+			if (!s._options._propagate or Grid_propagate( g, state, t )) {
+
+				Solver_recursive_mrv( s, g, state, d + 1 );
+
+			} else {
+
+				SearchStats_backtrack( st );
+
+			}
+
+			Trail_undo( g, state, t, mark );
+
+		}
+	}
+
+}
+
+/**
+ * Iteratively solve the Sudoku given the list of zero positions.
+ *
+ * The value of the position i is increased until it can be placed
+ * given the state of the constraints. If no value can be placed we
+ * reset the position and go back to the previous position, else we
+ * go forward to the next position.
+ *
+ * All positions set are recorded in the trail and marks[ i ] is the
+ * size of the trail before a value was placed at position i. If the
+ * propagation is used, positions set by the propagation have no mark
+ * and are skipped in both directions.
+ */
+static void Solver_iterative( Solver& s, Grid& g, GridState& state ) {
+
+	SearchContext& ctx = s._contexts[ 0 ]._ctx;
+	SearchStats& st = s._contexts[ 0 ]._stats;
+	vector< PositionCost >& epc = s._positions;
+	Trail& t = s._trail;
+
+	int m = static_cast<int>( epc.size() );
+
+	vector<int> marks( m, -1 );
+
+	bool forward = true;
+
+	int i = 0;
+	while ((i >= 0) and !SearchContext_stop( ctx )) {
+
+		if (i == m) {
+
+			if (GridState_satisfied( state ) == SATISFIED) {
+				Solver_record( s, 0, g );
+			}
+			--i;
+			forward = false;
+			continue;
+		}
+
+		int y = epc[ i ]._y;
+		int x = epc[ i ]._x;
+		int b = Grid_block_of( y, x );
+		GridElementType v = ZERO;
+
+		if (forward) {
+
+			if (Grid_get( g, y, x ) != ZERO) {
+				++i;
+				continue;
+			}
+			marks[ i ] = t._size;
+			SearchStats_node( st, i );
+
+		} else {
+
+			if (marks[ i ] < 0) {
+				--i;
+				continue;
+			}
+			v = Grid_get( g, y, x );
+			Trail_undo( g, state, t, marks[ i ] );
+
+		}
+
+		++v;
+		while ((v <= MAX_VAL) and !GridState_can_place( state, y, x, b, v )) {
+			SearchStats_check( st );
+			++v;
+		}
+
+		if (v > MAX_VAL) {
+			// no value was placed at the position
+			if (forward) SearchStats_backtrack( st );
+			marks[ i ] = -1;
+			--i;
+			forward = false;
+			continue;
+		}
+
+		SearchStats_check( st );
+		Grid_assign( g, state, t, y, x, v );
+		SearchStats_branch( st, i );
+
+		if (s._options._propagate and !Grid_propagate( g, state, t )) {
+			// try next value of the same position
+			SearchStats_backtrack( st );
+			forward = false;
+			continue;
+		}
+
+		++i;
+		forward = true;
+
+	}
+
+}
+
+/**
+ * Iteratively solve the Sudoku by choosing at each depth the empty
+ * position with the minimum number of values allowed (Minimum
+ * Remaining Values) instead of following a static order.
+ *
+ * The positions chosen are stored in a stack with the size of the
+ * trail before their value was placed.
+ */
+static void Solver_iterative_mrv( Solver& s, Grid& g, GridState& state ) {
+
+	SearchContext& ctx = s._contexts[ 0 ]._ctx;
+	SearchStats& st = s._contexts[ 0 ]._stats;
+	Trail& t = s._trail;
+
+	Position stack[ MAX_VAL * MAX_VAL ];
+	int marks[ MAX_VAL * MAX_VAL ];
+
+	bool forward = true;
+
+	int d = 0;
+	while ((d >= 0) and !SearchContext_stop( ctx )) {
+
+		int y, x;
+		GridElementType v = ZERO;
+
+		if (forward) {
+
+			int count = GridState_select_mrv( state, y, x );
+
+			if (count <= 0) {
+
+				if ((count < 0) and (GridState_satisfied( state ) == SATISFIED)) {
+					Solver_record( s, 0, g );
+				}
+				if (count == 0) {
+					SearchStats_node( st, d );
+					SearchStats_backtrack( st );
+				}
+				--d;
+				forward = false;
+				continue;
+			}
+
+			stack[ d ]._y = y;
+			stack[ d ]._x = x;
+			marks[ d ] = t._size;
+			SearchStats_node( st, d );
+
+		} else {
+
+			y = stack[ d ]._y;
+			x = stack[ d ]._x;
+			v = Grid_get( g, y, x );
+			Trail_undo( g, state, t, marks[ d ] );
+
+		}
+
+		// values allowed that are greater than v
+		GridMask candidates = GridState_candidates( state, y, x, Grid_block_of( y, x ) );
+		candidates &= ~((2 << v) - 1);
+
+		SearchStats_check( st );
+
+		if (candidates == 0) {
+			--d;
+			forward = false;
+			continue;
+		}
+
+		Grid_assign( g, state, t, y, x, __builtin_ctz( candidates ) );
+		SearchStats_branch( st, d );
+
+		if (s._options._propagate and !Grid_propagate( g, state, t )) {
+			// try next value of the same position
+			SearchStats_backtrack( st );
+			forward = false;
+			continue;
+		}
+
+		++d;
+		forward = true;
+
+	}
+
+}
+
+static bool Solver_template_solution( const GridN<3>& n, void *data ) {
+
+	Solver& s = *static_cast<Solver *>( data );
+	SearchContext& ctx = s._contexts[ 0 ]._ctx;
+
+	Grid g;
+	GridN_to_grid( n, g );
+	Solver_record( s, 0, g );
+
+	return (ctx._limit != nullptr) and SearchLimit_stop( *ctx._limit );
+
+}
+
+/**
+ * Solve the grid with the search of the grids of any size (see
+ * solver_n.h) which chooses the cells with the MRV like
+ * Solver_recursive_mrv() but keeps the list of the empty cells and
+ * uses the units computed by the compiler, which makes it faster.
+ * The solutions are recorded by the Solver.
+ */
+static void Solver_solve_template( Solver& s, Grid& g ) {
+
+	GridN<3> n;
+	GridN_from_grid( g, n );
+
+	SolverNResult<3> r;
+	if (!SolverN_solve( n, 0, r, Solver_template_solution, &s )) return;
+
+	SearchStats_add_nodes( s._contexts[ 0 ]._stats, r._nbr_nodes );
+
+	// the search stopped with values left to try
+	SearchContext& ctx = s._contexts[ 0 ]._ctx;
+	if (r._stopped and (ctx._limit != nullptr)) ctx._limit->_cut = true;
+
+}
+
+/**
+ * Solve the grid with one thread, the empty positions are sorted
+ * from the most constrained to the least constrained
+ */
+static void Solver_solve_sequential( Solver& s, Grid& g ) {
+
+	if ((s._options._engine == SOLVER_RECURSIVE) and s._options._mrv and !s._options._propagate) {
+		Solver_solve_template( s, g );
+		return;
+	}
+
+	vector< PositionCost >& epc = s._positions;
+
+	epc.clear();
+	Grid_find_empty_positions_costs( g, epc );
+
+	std::sort( epc.begin(), epc.end(), []( const PositionCost& a, const PositionCost& b) {
+		return a._cost > b._cost;
+	} );
+
+	if (s._options._reverse) {
+		std::reverse( epc.begin(), epc.end() );
+	}
+
+	GridState state;
+	GridState_init( state, g );
+
+	Trail_init( s._trail );
+
+	if (s._options._propagate and !Grid_propagate( g, state, s._trail )) return;
+
+	if (s._options._engine == SOLVER_ITERATIVE) {
+		if (s._options._mrv) {
+			Solver_iterative_mrv( s, g, state );
+		} else {
+			Solver_iterative( s, g, state );
+		}
+	} else {
+		if (s._options._mrv) {
+			Solver_recursive_mrv( s, g, state );
+		} else {
+			Solver_recursive( s, g, state );
+		}
+	}
+
+}
+
+
+static void Solver_dlx_solution( Grid& g, void *data ) {
+
+	Solver_record( *static_cast<Solver *>( data ), 0, g );
+
+}
+
+/**
+ * Solve the grid with the Dancing Links, the search of the Dancing
+ * Links applies the maximum number of solutions
+ */
+static void Solver_solve_dlx( Solver& s, Grid& g ) {
+
+	// the matrix is too large to be stored on the stack
+	if (s._dlx == nullptr) s._dlx = new DLX;
+
+	if (DLX_init( *s._dlx, g )) {
+		DLX_solve( *s._dlx, Solver_dlx_solution, &s, static_cast<int>( s._options._max_solutions ) );
+	}
+
+}
+
+// ==================================================================
+// PARALLEL SEARCHES
+// ==================================================================
+
+/**
+ * Recursively solve the seed grid given the list of positions that
+ * are empty in the seed grids
+ */
+static void Solver_seed_recursive( Solver& s, int thread, Grid& g, GridState& state,
+		vector< Position >& ep, int n ) {
+
+	if (SearchContext_stop( s._contexts[ thread ]._ctx )) return;
+
+	SearchStats& st = s._contexts[ thread ]._stats;
+
+	if (n >= static_cast<int>( ep.size() )) {
+
+		if (GridState_satisfied( state ) == SATISFIED) {
+			Solver_record( s, thread, g );
+		}
+
+	} else {
+
+		Position p = ep[ n ];
+		int b = Grid_block_of( p._y, p._x );
+		int branches = 0;
+
+		SearchStats_node( st, n );
+
+		for (GridElementType v = MIN_VAL; v <= MAX_VAL; ++v ) {
+
+			SearchStats_check( st );
+
+			if (GridState_can_place( state, p._y, p._x, b, v )) {
+
+				Grid_set( g, p._y, p._x, v );
+				GridState_place( state, p._y, p._x, b, v );
+				SearchStats_branch( st, n );
+				++branches;
+
+				Solver_seed_recursive( s, thread, g, state, ep, n + 1 );
+
+				GridState_remove( state, p._y, p._x, b, v );
+				Grid_set( g, p._y, p._x, ZERO );
+
+			}
+
+		}
+
+		if (branches == 0) SearchStats_backtrack( st );
+	}
+
+}
+
+/**
+ * Iteratively solve the seed grid given the list of positions that
+ * are empty in the seed grids
+ */
+static void Solver_seed_iterative( Solver& s, int thread, Grid& g, GridState& state,
+		vector< Position >& ep ) {
+
+	SearchContext& ctx = s._contexts[ thread ]._ctx;
+	SearchStats& st = s._contexts[ thread ]._stats;
+
+	int m = static_cast<int>( ep.size() );
+
+	int i = 0;
+	while ((i >= 0) and !SearchContext_stop( ctx )) {
+
+		if (i == m) {
+
+			if (GridState_satisfied( state ) == SATISFIED) {
+				Solver_record( s, thread, g );
+			}
+			--i;
+			continue;
+		}
+
+		int y = ep[ i ]._y;
+		int x = ep[ i ]._x;
+		int b = Grid_block_of( y, x );
+		GridElementType v = Grid_get( g, y, x );
+
+		// the position is reached from the previous position
+		bool forward = (v == ZERO);
+
+		if (forward) {
+			SearchStats_node( st, i );
+		} else {
+			GridState_remove( state, y, x, b, v );
+		}
+
+		++v;
+		while ((v <= MAX_VAL) and !GridState_can_place( state, y, x, b, v )) {
+			SearchStats_check( st );
+			++v;
+		}
+
+		if (v > MAX_VAL) {
+			if (forward) SearchStats_backtrack( st );
+			Grid_set( g, y, x, ZERO );
+			--i;
+		} else {
+			SearchStats_check( st );
+			Grid_set( g, y, x, v );
+			GridState_place( state, y, x, b, v );
+			SearchStats_branch( st, i );
+			++i;
+		}
+
+	}
+
+}
+
+
+/**
+ * Estimate the size of the subtree of the search below position
+ * ep[ n ]: return the log2 of the product of the numbers of values
+ * allowed in the positions ep[ n .. ], which is an upper bound of
+ * the number of leaves of the subtree, or -1 if one of the
+ * positions has no value allowed
+ */
+static double Solver_subtree_log2_size( GridState& state, vector< Position >& ep, int n ) {
+
+	double size = 0;
+
+	for (int i = n; i < static_cast<int>( ep.size() ); ++i) {
+		int count = GridMask_count( GridState_cell_candidates( state,
+			Grid_cell_of( ep[ i ]._y, ep[ i ]._x ) ) );
+		if (count == 0) return -1;
+		size += std::log2( count );
+	}
+
+	return size;
+
+}
+
+/**
+ * Recursively solve the grid by creating a task for each value of
+ * position ep[ n ] while n is less than the depth of the tasks and
+ * the estimated size of the subtree is at least
+ * 2^SOLVER_TASK_MIN_LOG2_SIZE leaves. Below the cutoff the search
+ * goes on in the task with Solver_seed_recursive(). Each task gets
+ * its own copy of the grid and of the state through firstprivate
+ * and places its value in it. The solutions are recorded in the
+ * context of the thread that runs the task.
+ *
+ * Return the number of tasks created in the subtree, summed by the
+ * task reduction of the taskgroup of each level.
+ */
+static uint64_t Solver_task_recursive( Solver& s, Grid& g, GridState& state,
+		vector< Position >& ep, int n ) {
+
+	int thread = omp_get_thread_num();
+
+	if ((n >= s._options._task_depth)
+			or (Solver_subtree_log2_size( state, ep, n ) < SOLVER_TASK_MIN_LOG2_SIZE)) {
+		Solver_seed_recursive( s, thread, g, state, ep, n );
+		return 0;
+	}
+
+	if (SearchContext_stop( s._contexts[ thread ]._ctx )) return 0;
+
+	SearchStats& st = s._contexts[ thread ]._stats;
+
+	Position p = ep[ n ];
+	int b = Grid_block_of( p._y, p._x );
+
+	uint64_t nbr_tasks = 0;
+
+	SearchStats_node( st, n );
+
+	#pragma omp taskgroup task_reduction( +: nbr_tasks )
+	{
+		for (GridElementType v = MIN_VAL; v <= MAX_VAL; ++v ) {
+
+			SearchStats_check( st );
+
+			if (GridState_can_place( state, p._y, p._x, b, v )) {
+
+				SearchStats_branch( st, n );
+
+				#pragma omp task firstprivate( g, state, p, b, v ) shared( s, ep ) in_reduction( +: nbr_tasks )
+				{
+					Grid_set( g, p._y, p._x, v );
+					GridState_place( state, p._y, p._x, b, v );
+					nbr_tasks += 1 + Solver_task_recursive( s, g, state, ep, n + 1 );
+				}
+			}
+
+		}
+	}
+
+	if (nbr_tasks == 0) SearchStats_backtrack( st );
+
+	return nbr_tasks;
+
+}
+
+/**
+ * Solve the grid with OpenMP tasks created by the recursion instead
+ * of seed grids: the empty positions are sorted like for the
+ * sequential search and the idle threads take the tasks that are
+ * not started, which balances the load without generating the tasks
+ * beforehand
+ */
+static void Solver_solve_tasks( Solver& s, Grid& g, SolverResult& r ) {
+
+	vector< PositionCost > epc;
+	Grid_find_empty_positions_costs( g, epc );
+
+	std::sort( epc.begin(), epc.end(), []( const PositionCost& a, const PositionCost& b) {
+		return a._cost > b._cost;
+	} );
+
+	if (s._options._reverse) {
+		std::reverse( epc.begin(), epc.end() );
+	}
+
+	vector< Position > empty_positions;
+
+	for (PositionCost& pc : epc) {
+		Position p;
+		p._y = pc._y;
+		p._x = pc._x;
+		empty_positions.push_back( p );
+	}
+
+	GridState state;
+	GridState_init( state, g );
+
+	uint64_t nbr_tasks = 0;
+
+	#pragma omp parallel num_threads( s._nbr_threads )
+	{
+		SearchStats& st = s._contexts[ omp_get_thread_num() ]._stats;
+
+		SearchStats_start( st );
+
+		#pragma omp single
+		nbr_tasks = Solver_task_recursive( s, g, state, empty_positions, 0 );
+
+		SearchStats_stop( st );
+	}
+
+	r._stats._nbr_tasks = nbr_tasks;
+
+}
+
+/**
+ * Copy next task of the parallel search into 'seed': the next seed
+ * grid of the generator if there is one, the next grid of the frontier
+ * otherwise. Return false if there is no task left.
+ */
+static bool Solver_next_task( SeedGenerator *generator, Frontier& f,
+		std::atomic<size_t>& next, Grid& seed ) {
+
+	if (generator != nullptr) return SeedGenerator_next( *generator, seed );
+
+	size_t i = next++;
+
+	if (i >= f._grids.size()) return false;
+
+	Grid_copy( seed, f._grids[ i ] );
+
+	return true;
+
+}
+
+
+static void Solver_ws_solution( Grid& g, void *data ) {
+
+	Solver_record( *static_cast<Solver *>( data ), omp_get_thread_num(), g );
+
+}
+
+/**
+ * Solve the seed grids given by the permutations of the most
+ * constrained blocks, or the grids of the frontier of the search
+ * tree, with the threads of the solver, either each thread takes a
+ * new grid when its previous grid is solved or the nodes of the
+ * searches are stolen by the threads
+ */
+static void Solver_solve_parallel( Solver& s, Grid& g, SearchLimit *limit, SolverResult& r ) {
+
+	SeedGenerator *generator = nullptr;
+	Frontier frontier;
+
+	if (s._options._frontier > 0) {
+
+		Frontier_expand( frontier, g, s._options._frontier, s._options._reverse );
+
+	} else {
+
+		vector< BlockCost > blocks_costs;
+		Solver_blocks_costs( g, blocks_costs );
+
+		int nbr_blocks = std::min( s._options._nbr_blocks, static_cast<int>( blocks_costs.size() ) );
+
+		generator = new SeedGenerator;
+		SeedGenerator_init( *generator, g, blocks_costs, nbr_blocks );
+
+	}
+
+	if (s._options._work_stealing) {
+
+		// the engine counts the solutions and applies the limit
+		for (int t = 0; t < s._nbr_threads; ++t) {
+			SearchContext_init( s._contexts[ t ]._ctx );
+		}
+
+		// the seed grids are the initial nodes of the workers
+		WorkStealing ws;
+		WorkStealing_init( ws, s._nbr_threads, generator, limit );
+
+		for (size_t i = 0; i < frontier._grids.size(); ++i) {
+			WorkStealing_push( ws, static_cast<int>( i % s._nbr_threads ), frontier._grids[ i ] );
+		}
+
+		WorkStealing_solve( ws, Solver_ws_solution, &s );
+
+		for (int w = 0; w < ws._nbr_workers; ++w) {
+			r._stats._nbr_nodes += ws._deques[ w ]._nbr_nodes;
+			r._stats._nbr_steals += ws._deques[ w ]._nbr_steals;
+			s._contexts[ w ]._stats = ws._deques[ w ]._stats;
+		}
+
+		WorkStealing_free( ws );
+
+	} else {
+
+		vector< Position > empty_positions;
+
+		// the order of the frontier is already reversed
+		if (generator == nullptr) {
+			Frontier_empty_positions( frontier, empty_positions );
+		} else {
+			SeedGenerator_empty_positions( *generator, empty_positions );
+
+			if (s._options._reverse) {
+				std::reverse( empty_positions.begin(), empty_positions.end() );
+			}
+		}
+
+		// index of the next grid of the frontier
+		std::atomic<size_t> next( 0 );
+
+		#pragma omp parallel num_threads( s._nbr_threads )
+		{
+			int thread = omp_get_thread_num();
+			SearchContext& ctx = s._contexts[ thread ]._ctx;
+			SearchStats& st = s._contexts[ thread ]._stats;
+			Grid seed;
+			GridState state;
+
+			SearchStats_start( st );
+
+			while (Solver_next_task( generator, frontier, next, seed ) and !SearchContext_stop( ctx )) {
+
+				GridState_init( state, seed );
+
+				long n = ctx._nbr_solutions;
+
+				if (s._options._engine == SOLVER_ITERATIVE) {
+					Solver_seed_iterative( s, thread, seed, state, empty_positions );
+				} else {
+					Solver_seed_recursive( s, thread, seed, state, empty_positions, 0 );
+				}
+
+				SearchStats_seed( st, ctx._nbr_solutions - n );
+			}
+
+			SearchStats_stop( st );
+		}
+
+	}
+
+	if (generator != nullptr) {
+		r._stats._nbr_seeds = generator->_nbr_seeds;
+		delete generator;
+	} else {
+		r._stats._nbr_seeds = frontier._grids.size();
+	}
+
+}
+
+
+/**
+ * Search the solutions of grid g
+ */
+static void Solver_search( Solver& s, Grid& g, SolverResult& r ) {
+
+	// the threads stop when the limit shared by all threads is reached
+	SearchLimit limit;
+	SearchLimit_init( limit, s._options._max_solutions );
+	SearchLimit *shared_limit = (s._options._max_solutions > 0) ? &limit : nullptr;
+
+	for (int t = 0; t < s._nbr_threads; ++t) {
+		SearchContext_init( s._contexts[ t ]._ctx, shared_limit );
+	}
+
+	// the searches modify the grid
+	Grid grid;
+	Grid_copy( grid, g );
+
+	if (s._options._engine == SOLVER_DLX) {
+		SearchContext_init( s._contexts[ 0 ]._ctx );
+		SearchStats_start( s._contexts[ 0 ]._stats );
+		Solver_solve_dlx( s, grid );
+		SearchStats_stop( s._contexts[ 0 ]._stats );
+		r._stopped = (s._dlx != nullptr) and s._dlx->_stopped;
+	} else if (s._options._parallel and (s._options._task_depth > 0)) {
+		Solver_solve_tasks( s, grid, r );
+	} else if (s._options._parallel) {
+		Solver_solve_parallel( s, grid, shared_limit, r );
+	} else {
+		SearchStats_start( s._contexts[ 0 ]._stats );
+		Solver_solve_sequential( s, grid );
+		SearchStats_stop( s._contexts[ 0 ]._stats );
+	}
+
+	// a search that finds the last solution allowed at the end of its
+	// tree is complete
+	if (shared_limit != nullptr) r._stopped = r._stopped or limit._cut;
+
+	for (int t = 0; t < s._nbr_threads; ++t) {
+		if (s._contexts[ t ]._buffer._writer != nullptr) {
+			SolutionBuffer_flush( s._contexts[ t ]._buffer );
+		}
+	}
+
+	SearchContext ctx;
+	SearchContext_reduce( ctx, s._contexts, s._nbr_threads );
+
+	r._nbr_solutions = ctx._nbr_solutions;
+	if (ctx._nbr_solutions > 0) Grid_copy( r._first_solution, ctx._first_solution );
+
+}
+
+
+bool Solver_solve( Solver& s, Grid& g, SolverResult& r ) {
+
+	r._nbr_solutions = 0;
+	r._stopped = false;
+	r._stats._nbr_threads = s._nbr_threads;
+	r._stats._nbr_seeds = 0;
+	r._stats._nbr_tasks = 0;
+	r._stats._nbr_nodes = 0;
+	r._stats._nbr_steals = 0;
+	r._stats._time = 0;
+	r._stats._cache_hit = false;
+	r._stats._store_hit = false;
+
+	for (int t = 0; t < s._nbr_threads; ++t) {
+		SearchStats_init( s._contexts[ t ]._stats );
+	}
+
+	if (Grid_satisfied( g ) == UNSATISFIED) return false;
+
+	double start = omp_get_wtime();
+
+	long max_solutions = s._options._max_solutions;
+
+	// the cache and the store only give the number of solutions and
+	// the first one
+	bool keep_flag = (s._options._writer == nullptr) and (s._options._callback == nullptr);
+	bool cache_flag = keep_flag and (s._options._cache != nullptr);
+	bool store_flag = keep_flag and (s._options._store != nullptr);
+
+	Grid canonical;
+	GridTransform transform;
+	CacheResult cached;
+
+	if (store_flag and PuzzleStore_find( *s._options._store, g, max_solutions, cached )) {
+
+		r._nbr_solutions = cached._nbr_solutions;
+		r._stopped = (cached._max_solutions != 0);
+		if (cached._nbr_solutions > 0) Grid_copy( r._first_solution, cached._first_solution );
+		r._stats._store_hit = true;
+
+	} else {
+
+		// the canonical form is only computed for the grids that may
+		// be in the cache
+		bool canonical_flag = cache_flag and ResultCache_seen( *s._options._cache, Grid_invariant( g ) );
+
+		if (canonical_flag) {
+
+			Grid_canonical( g, canonical, transform );
+
+			if (ResultCache_find( *s._options._cache, canonical, max_solutions, cached )) {
+
+				r._nbr_solutions = cached._nbr_solutions;
+				r._stopped = (cached._max_solutions != 0);
+				if (cached._nbr_solutions > 0) {
+					Grid_untransform( transform, cached._first_solution, r._first_solution );
+				}
+				r._stats._cache_hit = true;
+			}
+		}
+
+		if (!r._stats._cache_hit) {
+
+			Solver_search( s, g, r );
+
+			if (canonical_flag) {
+
+				// the limit is only kept if the search was stopped
+				cached._nbr_solutions = r._nbr_solutions;
+				cached._max_solutions = r._stopped ? max_solutions : 0;
+				if (r._nbr_solutions > 0) {
+					Grid_transform( transform, r._first_solution, cached._first_solution );
+				}
+
+				ResultCache_insert( *s._options._cache, canonical, cached );
+			}
+		}
+
+		if (store_flag) {
+
+			cached._nbr_solutions = r._nbr_solutions;
+			cached._max_solutions = r._stopped ? max_solutions : 0;
+			if (r._nbr_solutions > 0) Grid_copy( cached._first_solution, r._first_solution );
+
+			PuzzleStore_insert( *s._options._store, g, cached );
+		}
+	}
+
+	r._stats._time = omp_get_wtime() - start;
+
+	return true;
+
+}
+
+
+void Solver_print_stats( Solver& s, ostream& out, bool json ) {
+
+	vector< SearchStats * > stats;
+
+	for (int t = 0; t < s._nbr_threads; ++t) {
+		stats.push_back( &s._contexts[ t ]._stats );
+	}
+
+	if (json) {
+		SearchStats_print_json( out, stats );
+	} else {
+		SearchStats_print( out, stats );
+	}
+
+}
+
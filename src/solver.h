@@ -0,0 +1,207 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <vector>
+#include "grid.h"
+#include "grid_state.h"
+#include "block_cost.h"
+#include "propagation.h"
+#include "search_context.h"
+#include "solution_writer.h"
+#include "result_cache.h"
+#include "puzzle_store.h"
+#include "dlx.h"
+
+/**
+ * Solver of grids that can be used by another program: the options
+ * of the search are given to Solver_init() and each call to
+ * Solver_solve() fills a result. The solver has no global state, it
+ * keeps the contexts of its threads, its trail and the matrix of the
+ * Dancing Links between two calls so that they are not allocated
+ * for each grid. The threads of the parallel searches are the threads
+ * of OpenMP which are kept from one parallel region to the next.
+ *
+ * Example:
+ *
+ *   SolverOptions options;
+ *   SolverOptions_init( options );
+ *   options._engine = SOLVER_ITERATIVE;
+ *   options._parallel = true;
+ *
+ *   Solver solver;
+ *   Solver_init( solver, options );
+ *
+ *   SolverResult result;
+ *   if (Solver_solve( solver, grid, result )) {
+ *     cout << result._nbr_solutions << endl;
+ *   }
+ *
+ *   Solver_free( solver );
+ */
+
+// search engines
+const int SOLVER_RECURSIVE = 0;
+const int SOLVER_ITERATIVE = 1;
+const int SOLVER_DLX       = 2;
+
+// the recursive parallel search creates tasks for a node only if the
+// product of the numbers of values allowed in its empty positions is
+// at least 2^SOLVER_TASK_MIN_LOG2_SIZE, a smaller subtree is solved
+// too fast to be worth tasks
+const double SOLVER_TASK_MIN_LOG2_SIZE = 20;
+
+/**
+ * Function called for each solution found. In a parallel search it
+ * is called by several threads at the same time, 'thread' is the
+ * index of the thread in [0..nbr_threads-1].
+ */
+typedef void (*Solver_SolutionCallback)( Grid& solution, int thread, void *data );
+
+typedef struct SolverOptions {
+	// SOLVER_RECURSIVE, SOLVER_ITERATIVE or SOLVER_DLX
+	int _engine;
+	// choose the empty position with the minimum number of values
+	// allowed instead of following a static order (sequential search),
+	// without _propagate the recursive search is the one of solver_n.h
+	bool _mrv;
+	// propagate the naked and hidden singles (sequential search)
+	bool _propagate;
+	// reverse the static order of the empty positions
+	bool _reverse;
+
+	// solve the seed grids obtained from the permutations of the
+	// _nbr_blocks most constrained blocks with several threads
+	// (recursive or iterative engine)
+	bool _parallel;
+	// number of threads, 0 to use the number of threads of OpenMP
+	int _nbr_threads;
+	int _nbr_blocks;
+	// if not 0, the tasks of the threads are the grids of a frontier
+	// of at least this number of nodes of the search tree instead of
+	// the seed grids of the blocks (see frontier.h)
+	size_t _frontier;
+	// the threads steal the nodes of the search of the other threads
+	// instead of solving whole seed grids
+	bool _work_stealing;
+	// if not 0, the recursive search creates a task with a copy of
+	// the grid for each branch of the first _task_depth levels of the
+	// tree (see SOLVER_TASK_MIN_LOG2_SIZE), the seed grids, the frontier and the work stealing are
+	// then not used
+	int _task_depth;
+
+	// the search stops after this number of solutions, 0 to find all
+	// solutions
+	long _max_solutions;
+
+	// results of the grids already solved, can be null. The cache is
+	// not used if the solutions are written or given to the callback
+	ResultCache *_cache;
+	// results kept in a file, can be null. It is looked at before the
+	// cache and is not used in the same cases
+	PuzzleStore *_store;
+
+	// writer of all the solutions, can be null
+	SolutionWriter *_writer;
+	// called for each solution, can be null
+	Solver_SolutionCallback _callback;
+	void *_data;
+
+} SolverOptions;
+
+/**
+ * Statistics of the last search
+ */
+typedef struct SolverStats {
+	int _nbr_threads;
+	// number of seed grids or grids of the frontier of the parallel
+	// search
+	uint64_t _nbr_seeds;
+	// number of OpenMP tasks created by the recursion when
+	// _task_depth is not 0
+	uint64_t _nbr_tasks;
+	// nodes explored and stolen by the work stealing threads
+	uint64_t _nbr_nodes;
+	uint64_t _nbr_steals;
+	// the result was found in the cache
+	bool _cache_hit;
+	// the result was found in the store
+	bool _store_hit;
+	// time of the search in seconds
+	double _time;
+
+} SolverStats;
+
+typedef struct SolverResult {
+	long _nbr_solutions;
+	// true if the search stopped because _max_solutions solutions
+	// were found before the whole tree was explored
+	bool _stopped;
+	// valid if there is at least one solution
+	Grid _first_solution;
+	SolverStats _stats;
+
+} SolverResult;
+
+typedef struct Solver {
+	SolverOptions _options;
+	int _nbr_threads;
+	// contexts of the threads, the buffers of the solutions are kept
+	// between two searches
+	ThreadContext *_contexts;
+	// empty positions and trail of the sequential search
+	std::vector< PositionCost > _positions;
+	Trail _trail;
+	// matrix of the Dancing Links, allocated when first used
+	DLX *_dlx;
+
+} Solver;
+
+/**
+ * Set default options: sequential recursive search of all solutions
+ */
+void SolverOptions_init( SolverOptions& o );
+
+/**
+ * Initialize solver with the options
+ */
+void Solver_init( Solver& s, SolverOptions& o );
+
+/**
+ * Free the memory used by the solver
+ */
+void Solver_free( Solver& s );
+
+/**
+ * Find the solutions of grid g which is not modified. Return false
+ * if the grid violates the constraints and can't be solved, the
+ * result is then empty. The solutions left in the buffers of the
+ * threads are given to the writer before returning.
+ */
+bool Solver_solve( Solver& s, Grid& g, SolverResult& r );
+
+/**
+ * Find the blocks of the grid that are not filled sorted from the
+ * most constrained to the least constrained, the number of values
+ * set in the block is the cost of the block. The permutations of
+ * the first blocks give the seed grids of the parallel search.
+ */
+void Solver_blocks_costs( Grid& g, vector< BlockCost >& blocks_costs );
+
+/**
+ * Print the statistics of the threads of the last search, in JSON if
+ * json is true. The statistics are empty if the program is not
+ * compiled with SEARCH_STATS (see search_stats.h).
+ */
+void Solver_print_stats( Solver& s, ostream& out, bool json = false );
+
@@ -0,0 +1,178 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <omp.h>
+#include "grid_n.h"
+
+/**
+ * Sequential recursive search of the solutions of grids of any size
+ * (see grid_n.h). At each node the empty cell with the fewest values
+ * allowed is chosen, so a cell with only one value is filled without
+ * branching. The empty cells not filled yet are kept at the end of
+ * the list of the state: choosing a cell swaps it with the first of
+ * them, the swap is not undone as the order of the cells left doesn't
+ * matter.
+ *
+ * Example:
+ *
+ *   GridN<4> grid;
+ *   GridN_read( cin, grid );
+ *
+ *   SolverNResult<4> result;
+ *   if (SolverN_solve( grid, 0, result )) {
+ *     cout << result._nbr_solutions << endl;
+ *   }
+ */
+
+template <int BOX>
+struct SolverNResult {
+	long _nbr_solutions;
+	// true if the search stopped because max_solutions solutions
+	// were found before the whole tree was explored
+	bool _stopped;
+	// valid if there is at least one solution
+	GridN<BOX> _first_solution;
+	// nodes of the search and time in seconds
+	uint64_t _nbr_nodes;
+	double _time;
+
+};
+
+/**
+ * Function called for each solution with the data given to
+ * SolverN_solve(), the search stops if it returns true
+ */
+template <int BOX>
+using SolverNSolution = bool (*)( const GridN<BOX>& g, void *data );
+
+template <int BOX>
+struct SolverN {
+	GridN<BOX> _grid;
+	GridNState<BOX> _state;
+	long _max_solutions;
+	SolverNResult<BOX> *_result;
+	// null if the solutions are only counted
+	SolverNSolution<BOX> _solution;
+	void *_data;
+
+};
+
+/**
+ * Fill the empty cells from index 'depth' of the list of the empty
+ * cells. Return true if the search must stop.
+ */
+template <int BOX>
+bool SolverN_search( SolverN<BOX>& s, int depth ) {
+
+	GridNState<BOX>& st = s._state;
+	SolverNResult<BOX>& r = *s._result;
+
+	if (depth == st._nbr_empty) {
+
+		if (r._nbr_solutions == 0) r._first_solution = s._grid;
+		++r._nbr_solutions;
+
+		if (s._solution != nullptr) return s._solution( s._grid, s._data );
+
+		return (s._max_solutions > 0) and (r._nbr_solutions >= s._max_solutions);
+	}
+
+	++r._nbr_nodes;
+
+	// cell with the minimum number of values allowed
+	int best = depth;
+	int best_count = GridNTraits<BOX>::SIZE + 1;
+	GridNMask<BOX> candidates = 0;
+
+	for (int i = depth; i < st._nbr_empty; ++i) {
+
+		GridNMask<BOX> m = GridNState_candidates( st, st._empty[ i ] );
+		int count = __builtin_popcount( m );
+
+		if (count < best_count) {
+			best = i;
+			best_count = count;
+			candidates = m;
+
+			// no better choice than a cell with 0 or 1 value
+			if (count <= 1) break;
+		}
+	}
+
+	if (best_count == 0) return false;
+
+	int c = st._empty[ best ];
+	st._empty[ best ] = st._empty[ depth ];
+	st._empty[ depth ] = static_cast<uint16_t>( c );
+
+	while (candidates != 0) {
+
+		GridNMask<BOX> m = candidates & (~candidates + 1);
+		candidates ^= m;
+
+		s._grid._cells[ c ] = static_cast<uint8_t>( __builtin_ctz( m ) + 1 );
+		GridNState_flip( st, c, m );
+
+		bool stop = SolverN_search( s, depth + 1 );
+
+		GridNState_flip( st, c, m );
+
+		if (stop) {
+			// values left to try, the search is cut short
+			if (candidates != 0) r._stopped = true;
+			s._grid._cells[ c ] = ZERO;
+			return true;
+		}
+	}
+
+	s._grid._cells[ c ] = ZERO;
+
+	return false;
+
+}
+
+/**
+ * Find the solutions of grid g, the search stops after max_solutions
+ * solutions if it is not 0. If solution is not null, it is called
+ * for each solution and decides when the search stops instead of
+ * max_solutions. Return false if the grid violates the constraints
+ * and can't be solved, the result is then empty.
+ */
+template <int BOX>
+bool SolverN_solve( const GridN<BOX>& g, long max_solutions, SolverNResult<BOX>& r,
+		SolverNSolution<BOX> solution = nullptr, void *data = nullptr ) {
+
+	r._nbr_solutions = 0;
+	r._stopped = false;
+	r._nbr_nodes = 0;
+	r._time = 0;
+
+	SolverN<BOX> s;
+	s._grid = g;
+	s._max_solutions = max_solutions;
+	s._result = &r;
+	s._solution = solution;
+	s._data = data;
+
+	if (GridNState_init( s._state, g ) == UNSATISFIED) return false;
+
+	double start = omp_get_wtime();
+
+	SolverN_search( s, 0 );
+	r._time = omp_get_wtime() - start;
+
+	return true;
+
+}
+
@@ -0,0 +1,532 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+using namespace std;
+#include <getopt.h>
+#include <omp.h>
+#include "grid.h"
+#include "puzzle_file.h"
+#include "grid_kernels.h"
+#include "seed_generator.h"
+#include "solver.h"
+#include "canonical.h"
+#include "perf_counters.h"
+#include "solver_n.h"
+
+/**
+ * Microbenchmarks of the functions on grids and of the searches.
+ *
+ * Each benchmark is a function that is called a number of iterations
+ * chosen so that a repetition lasts at least the minimum time. After
+ * the warmup repetitions, the time of each repetition divided by the
+ * number of iterations gives one measure. The median, the minimum,
+ * the mean and the standard deviation of the measures are written in
+ * JSON, one benchmark per line, so that the results of two builds can
+ * be compared with diff.
+ */
+
+// ==================================================================
+// GLOBAL VARIABLES
+// ==================================================================
+int repetitions = 10;
+int warmup = 2;
+// minimum time of a repetition in milliseconds
+double min_time = 20;
+// only the benchmarks whose name contains the filter are run
+string filter;
+string output_file_name;
+// directory of the puzzles of the end-to-end solves
+string corpus_dir = "examples";
+// count the hardware events of the repetitions
+bool perf_flag = false;
+
+// the values returned by the benchmarks are added so that the
+// compiler can't remove the calls
+volatile uint64_t bench_sink = 0;
+
+typedef struct Benchmark {
+	string _name;
+	// kernel selected before the benchmark is run, nullptr to keep the
+	// kernel selected at start
+	const char *_kernel;
+	std::function< uint64_t () > _run;
+
+} Benchmark;
+
+typedef struct BenchResult {
+	string _name;
+	// calls of the function in one repetition
+	long _iterations;
+	// time of a call in nanoseconds
+	double _median;
+	double _min;
+	double _mean;
+	double _stddev;
+	// hardware events of all the repetitions
+	PerfCounters _perf;
+
+} BenchResult;
+
+/**
+ * Return time in nanoseconds of n calls to the benchmark
+ */
+static double Bench_time( Benchmark& b, long n ) {
+
+	uint64_t sink = 0;
+
+	auto start = chrono::steady_clock::now();
+
+	for (long i = 0; i < n; ++i) {
+		sink += b._run();
+	}
+
+	auto stop = chrono::steady_clock::now();
+
+	bench_sink += sink;
+
+	return chrono::duration<double, nano>( stop - start ).count();
+
+}
+
+/**
+ * Find the number of iterations of a repetition so that it lasts at
+ * least min_time milliseconds
+ */
+static long Bench_calibrate( Benchmark& b ) {
+
+	long n = 1;
+
+	while (true) {
+
+		double t = Bench_time( b, n );
+
+		if (t >= min_time * 1e6) break;
+
+		// grow from the time of the last try but at most 10 times
+		double factor = (t > 0) ? 1.2 * min_time * 1e6 / t : 10;
+		n = static_cast<long>( n * std::min( std::max( factor, 2.0 ), 10.0 ) );
+	}
+
+	return n;
+
+}
+
+
+static void Bench_run( Benchmark& b, BenchResult& r ) {
+
+	const char *kernel = Grid_kernel_name();
+
+	if (b._kernel != nullptr) Grid_select_kernel( b._kernel );
+
+	r._name = b._name;
+	r._iterations = Bench_calibrate( b );
+
+	for (int i = 0; i < warmup; ++i) {
+		Bench_time( b, r._iterations );
+	}
+
+	vector< double > measures;
+
+	PerfCounters_init( r._perf );
+	if (perf_flag) PerfCounters_start( r._perf );
+
+	for (int i = 0; i < repetitions; ++i) {
+		measures.push_back( Bench_time( b, r._iterations ) / r._iterations );
+	}
+
+	if (perf_flag) PerfCounters_stop( r._perf );
+
+	std::sort( measures.begin(), measures.end() );
+
+	size_t n = measures.size();
+
+	r._min = measures[ 0 ];
+	r._median = ((n % 2) == 1) ? measures[ n / 2 ] : (measures[ n / 2 - 1 ] + measures[ n / 2 ]) / 2;
+
+	double sum = 0;
+	for (double m : measures) sum += m;
+	r._mean = sum / n;
+
+	double var = 0;
+	for (double m : measures) var += (m - r._mean) * (m - r._mean);
+	r._stddev = (n > 1) ? sqrt( var / (n - 1) ) : 0;
+
+	Grid_select_kernel( kernel );
+
+}
+
+
+static void Bench_print_json( ostream& out, vector< BenchResult >& results ) {
+
+	char date[ 32 ];
+	time_t now = time( nullptr );
+	strftime( date, sizeof( date ), "%Y-%m-%d %H:%M:%S", localtime( &now ) );
+
+	out << fixed << setprecision( 2 );
+	out << "{" << endl;
+	out << "  \"context\": { \"date\": \"" << date << "\", \"compiler\": \"" << __VERSION__
+		<< "\", \"kernel\": \"" << Grid_kernel_name() << "\", \"threads\": " << omp_get_max_threads()
+		<< ", \"repetitions\": " << repetitions << ", \"warmup\": " << warmup
+		<< ", \"min_time_ms\": " << min_time << " }," << endl;
+	out << "  \"benchmarks\": [" << endl;
+
+	for (size_t i = 0; i < results.size(); ++i) {
+
+		BenchResult& r = results[ i ];
+
+		out << "    { \"name\": \"" << r._name << "\", \"iterations\": " << r._iterations
+			<< ", \"median_ns\": " << r._median << ", \"min_ns\": " << r._min
+			<< ", \"mean_ns\": " << r._mean << ", \"stddev_ns\": " << r._stddev;
+
+		// events of one call
+		if (perf_flag) {
+			out << ", \"perf\": { ";
+			PerfCounters_print_json( out, r._perf, static_cast<double>( r._iterations ) * repetitions );
+			out << " }";
+		}
+
+		out << " }";
+		out << ((i + 1 < results.size()) ? "," : "") << endl;
+	}
+
+	out << "  ]" << endl;
+	out << "}" << endl;
+
+}
+
+/**
+ * Read the first grid of the file of the corpus, exit if the file
+ * can't be read
+ */
+static void Bench_read_grid( string name, Grid& g ) {
+
+	string file_name = corpus_dir + "/" + name;
+
+	PuzzleFile pf;
+
+	bool read_flag = PuzzleFile_open( pf, file_name.c_str() );
+	if (read_flag) {
+		read_flag = PuzzleFile_next( pf, g );
+		PuzzleFile_close( pf );
+	}
+
+	if (!read_flag) {
+		cerr << "error: could not read grid from file '" << file_name << "'" << endl;
+		exit( EXIT_FAILURE );
+	}
+
+}
+
+
+/**
+ * main function
+ *
+ */
+int main( int argc, char *argv[] ) {
+
+	static struct option long_options[] = {
+
+		{ "repetitions", required_argument, 0, 'r' },
+		{ "warmup", required_argument, 0, 'w' },
+		{ "min-time", required_argument, 0, 'm' },
+		{ "filter", required_argument, 0, 'f' },
+		{ "output", required_argument, 0, 'o' },
+		{ "corpus", required_argument, 0, 'c' },
+		{ "kernel", required_argument, 0, 'k' },
+		{ "perf", no_argument, 0, 'p' },
+		{ 0, 0, 0, 0 }
+
+	};
+
+	int option_index = 0;
+	while (true) {
+
+		int c = getopt_long( argc, argv, "r:w:m:f:o:c:k:p", long_options, &option_index );
+
+		if (c == -1) break;
+
+		switch( c ) {
+			case 'r':
+				repetitions = std::max( atoi( optarg ), 1 );
+				break;
+
+			case 'w':
+				warmup = atoi( optarg );
+				break;
+
+			case 'm':
+				min_time = atof( optarg );
+				break;
+
+			case 'f':
+				filter = optarg;
+				break;
+
+			case 'o':
+				output_file_name = optarg;
+				break;
+
+			case 'c':
+				corpus_dir = optarg;
+				break;
+
+			case 'k':
+				if (!Grid_select_kernel( optarg )) {
+					cerr << "error: kernel '" << optarg << "' is unknown or not supported" << endl;
+					exit( EXIT_FAILURE );
+				}
+				break;
+
+			case 'p':
+				perf_flag = true;
+				break;
+
+			default:
+				cerr << "Unknown option	!" << endl;
+				exit( EXIT_FAILURE );
+		}
+
+	}
+
+	// fixed corpus: the first grid of each file
+	const char *puzzles[] = { "6_solutions.txt", "237_solutions.txt", "2315_solutions.txt" };
+	const int nbr_puzzles = 3;
+
+	Grid grids[ nbr_puzzles ];
+	for (int i = 0; i < nbr_puzzles; ++i) {
+		Bench_read_grid( puzzles[ i ], grids[ i ] );
+	}
+
+	Grid& puzzle = grids[ nbr_puzzles - 1 ];
+	string text = Grid_to_string( puzzle );
+
+	// a solution of the puzzle, where all the units are checked
+	Grid solution;
+	{
+		SolverOptions options;
+		SolverOptions_init( options );
+		options._engine = SOLVER_DLX;
+		options._max_solutions = 1;
+
+		Solver solver;
+		SolverResult result;
+		Solver_init( solver, options );
+		Solver_solve( solver, puzzle, result );
+		Solver_free( solver );
+		Grid_copy( solution, result._first_solution );
+	}
+
+	vector< Benchmark > benchmarks;
+
+	Grid g;
+	Grid_init( g );
+
+	benchmarks.push_back( { "grid_fill", nullptr, [&]() -> uint64_t {
+		Grid_fill( g, text );
+		return Grid_get( g, 1, 1 );
+	} } );
+
+	benchmarks.push_back( { "grid_row_satisfied", nullptr, [&]() -> uint64_t {
+		uint64_t sum = 0;
+		for (int y = MIN_VAL; y <= MAX_VAL; ++y) sum += Grid_row_satisfied( solution, y );
+		return sum;
+	} } );
+
+	benchmarks.push_back( { "grid_col_satisfied", nullptr, [&]() -> uint64_t {
+		uint64_t sum = 0;
+		for (int x = MIN_VAL; x <= MAX_VAL; ++x) sum += Grid_col_satisfied( solution, x );
+		return sum;
+	} } );
+
+	benchmarks.push_back( { "grid_blk_satisfied", nullptr, [&]() -> uint64_t {
+		uint64_t sum = 0;
+		for (int b = MIN_VAL; b <= MAX_VAL; ++b) sum += Grid_blk_satisfied( solution, b );
+		return sum;
+	} } );
+
+	// one benchmark for each kernel supported by the processor
+	const char *kernels[] = { "scalar", "sse4", "avx2" };
+	const char *selected_kernel = Grid_kernel_name();
+
+	for (const char *kernel : kernels) {
+		if (!Grid_select_kernel( kernel )) continue;
+		benchmarks.push_back( { string( "grid_satisfied/" ) + kernel, kernel, [&]() -> uint64_t {
+			return Grid_satisfied( solution );
+		} } );
+	}
+
+	Grid_select_kernel( selected_kernel );
+
+	vector< PositionCost > positions_costs;
+
+	benchmarks.push_back( { "grid_find_empty_positions_costs", nullptr, [&]() -> uint64_t {
+		positions_costs.clear();
+		Grid_find_empty_positions_costs( puzzle, positions_costs );
+		return positions_costs.size();
+	} } );
+
+	// seed grids of the parallel searches with 3 blocks
+	vector< BlockCost > blocks_costs;
+	Solver_blocks_costs( puzzle, blocks_costs );
+
+	SeedGenerator *generator = new SeedGenerator;
+	Grid seed;
+
+	benchmarks.push_back( { "seed_generator/3_blocks", nullptr, [&]() -> uint64_t {
+		SeedGenerator_init( *generator, puzzle, blocks_costs, 3 );
+		uint64_t n = 0;
+		while (SeedGenerator_next( *generator, seed )) ++n;
+		return n;
+	} } );
+
+	// end-to-end solves, the solvers are kept between two calls like
+	// in batch mode
+	typedef struct BenchEngine {
+		const char *_name;
+		int _engine;
+		bool _mrv;
+		bool _propagate;
+
+	} BenchEngine;
+
+	BenchEngine engines[] = {
+		{ "recursive", SOLVER_RECURSIVE, false, false },
+		{ "recursive_mrv", SOLVER_RECURSIVE, true, false },
+		{ "recursive_mrv_propagate", SOLVER_RECURSIVE, true, true },
+		{ "iterative", SOLVER_ITERATIVE, false, false },
+		{ "dlx", SOLVER_DLX, false, false }
+	};
+
+	vector< Solver * > solvers;
+
+	for (BenchEngine& e : engines) {
+
+		SolverOptions options;
+		SolverOptions_init( options );
+		options._engine = e._engine;
+		options._mrv = e._mrv;
+		options._propagate = e._propagate;
+
+		Solver *solver = new Solver;
+		Solver_init( *solver, options );
+		solvers.push_back( solver );
+
+		for (int i = 0; i < nbr_puzzles; ++i) {
+			Grid *grid = &grids[ i ];
+			string name = string( "solve/" ) + e._name + "/" + puzzles[ i ];
+			name = name.substr( 0, name.size() - 4 );
+			benchmarks.push_back( { name, nullptr, [solver, grid]() -> uint64_t {
+				SolverResult result;
+				Solver_solve( *solver, *grid, result );
+				return result._nbr_solutions;
+			} } );
+		}
+	}
+
+	// canonical form of the grids looked up in the cache of results,
+	// to compare with the solves above
+	for (int i = 0; i < nbr_puzzles; ++i) {
+		Grid *grid = &grids[ i ];
+		string name = string( "grid_canonical/" ) + puzzles[ i ];
+		name = name.substr( 0, name.size() - 4 );
+		benchmarks.push_back( { name, nullptr, [grid]() -> uint64_t {
+			Grid canonical;
+			GridTransform transform;
+			Grid_canonical( *grid, canonical, transform );
+			return Grid_get( canonical, MAX_VAL, MAX_VAL );
+		} } );
+	}
+
+	benchmarks.push_back( { "grid_invariant", nullptr, [&]() -> uint64_t {
+		return Grid_invariant( puzzle );
+	} } );
+
+	// search of the grids of any size on the same grids and on a 16x16
+	// grid (see solver_n.h)
+	GridN<3> *grids_n = new GridN<3>[ nbr_puzzles ];
+
+	for (int i = 0; i < nbr_puzzles; ++i) {
+
+		GridN_from_grid( grids[ i ], grids_n[ i ] );
+
+		GridN<3> *grid = &grids_n[ i ];
+		string name = string( "solve/generic/" ) + puzzles[ i ];
+		name = name.substr( 0, name.size() - 4 );
+		benchmarks.push_back( { name, nullptr, [grid]() -> uint64_t {
+			SolverNResult<3> result;
+			SolverN_solve( *grid, 0, result );
+			return result._nbr_solutions;
+		} } );
+	}
+
+	GridN<4> *grid_16 = new GridN<4>;
+	{
+		string file_name = corpus_dir + "/16x16_1_solution.txt";
+		ifstream in( file_name.c_str() );
+
+		if (!GridN_read( in, *grid_16 )) {
+			cerr << "error: could not read grid from file '" << file_name << "'" << endl;
+			exit( EXIT_FAILURE );
+		}
+	}
+
+	benchmarks.push_back( { "solve/generic/16x16_1_solution", nullptr, [grid_16]() -> uint64_t {
+		SolverNResult<4> result;
+		SolverN_solve( *grid_16, 0, result );
+		return result._nbr_solutions;
+	} } );
+
+	vector< BenchResult > results;
+
+	for (Benchmark& b : benchmarks) {
+
+		if ((filter.size() != 0) and (b._name.find( filter ) == string::npos)) continue;
+
+		BenchResult r;
+		Bench_run( b, r );
+		results.push_back( r );
+
+		cerr << "- " << left << setw( 40 ) << r._name << right << fixed << setprecision( 1 )
+			<< setw( 14 ) << r._median << " ns" << endl;
+	}
+
+	if (perf_flag and !results.empty() and !PerfCounters_available( results[ 0 ]._perf )) {
+		cerr << "- hardware counters not available" << endl;
+	}
+
+	if (output_file_name.size() == 0) {
+
+		Bench_print_json( cout, results );
+
+	} else {
+
+		ofstream out( output_file_name.c_str() );
+
+		if (!out) {
+			cerr << "error: could not create file '" << output_file_name << "'" << endl;
+			exit( EXIT_FAILURE );
+		}
+
+		Bench_print_json( out, results );
+		cerr << "- results written to " << output_file_name << endl;
+
+	}
+
+	for (Solver *solver : solvers) {
+		Solver_free( *solver );
+		delete solver;
+	}
+
+	delete generator;
+	delete [] grids_n;
+	delete grid_16;
+
+	return EXIT_SUCCESS;
+}
+
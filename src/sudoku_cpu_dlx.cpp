@@ -0,0 +1,386 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+using namespace std;
+#include <getopt.h>
+#include "grid.h"
+#include "puzzle_file.h"
+#include "grid_kernels.h"
+#include "solver.h"
+#include "batch.h"
+#include "solution_writer.h"
+
+
+ostream& operator<<( ostream& out, Grid& grid ) {
+	return Grid_print( out, grid );
+}
+
+// ==================================================================
+// GLOBAL VARIABLES
+// ==================================================================
+int verbose_level = 1;
+// file where all the solutions are written, "-" for the standard output
+string solutions_file_name;
+bool packed_flag = false;
+string store_file_name;
+// print the statistics of the search, in JSON in the file
+bool stats_flag = false;
+string stats_file_name;
+// add the hardware counters to the statistics
+bool perf_flag = false;
+bool print_first_flag = false;
+
+string satisfied_strings[] = {
+	"unsatisfied",
+	"almost",
+	"*** not defined ***",
+	"satisfied"
+};
+
+
+/**
+ * main function
+ *
+ */
+int main( int argc, char *argv[] ) {
+
+	string input;
+	string input_file_name;
+	string batch_file_name;
+	int nbr_threads = 1;
+	bool ordered_flag = true;
+	bool verify_flag = false;
+	// maximum number of results kept in the cache in batch mode
+	long cache_size = 0;
+	// options of the search
+	SolverOptions options;
+	SolverOptions_init( options );
+	options._engine = SOLVER_DLX;
+
+	static struct option long_options[] = {
+
+		{ "verbose-level", required_argument, 0, 'v' },
+		{ "input", required_argument, 0, 'i' },
+		{ "kernel", required_argument, 0, 'k' },
+		{ "verify", no_argument, 0, 'V' },
+		{ "batch", required_argument, 0, 'B' },
+		{ "threads", required_argument, 0, 't' },
+		{ "unordered", no_argument, 0, 'u' },
+		{ "print-first", no_argument, 0, 'f' },
+		{ "max-solutions", required_argument, 0, 'n' },
+		{ "solutions", required_argument, 0, 's' },
+		{ "packed", no_argument, 0, 'P' },
+		{ "store", required_argument, 0, 'S' },
+		{ "stats", no_argument, 0, 'T' },
+		{ "stats-json", required_argument, 0, 'J' },
+		{ "perf", no_argument, 0, 'H' },
+		{ "cache", required_argument, 0, 'c' },
+		{ 0, 0, 0, 0 }
+
+	};
+
+	int option_index = 0;
+	while (true) {
+
+		int c = getopt_long( argc, argv, "v:i:fB:t:uk:Vn:s:PS:TJ:Hc:", long_options, &option_index );
+
+		if (c == -1) break;
+
+		switch( c ) {
+			case 'v':
+				verbose_level = atoi( optarg );
+				break;
+
+			case 'i':
+				input_file_name = optarg;
+				break;
+
+			case 'k':
+				if (!Grid_select_kernel( optarg )) {
+					cerr << "error: kernel '" << optarg << "' is unknown or not supported" << endl;
+					exit( EXIT_FAILURE );
+				}
+				break;
+
+			case 'V':
+				verify_flag = true;
+				break;
+
+			case 'B':
+				batch_file_name = optarg;
+				break;
+
+			case 't':
+				nbr_threads = atoi( optarg );
+				break;
+
+			case 'u':
+				ordered_flag = false;
+				break;
+
+			case 'f':
+				print_first_flag = true;
+				break;
+
+			case 'n':
+				options._max_solutions = atol( optarg );
+				break;
+
+			case 's':
+				solutions_file_name = optarg;
+				break;
+
+			case 'P':
+				packed_flag = true;
+				break;
+
+			case 'S':
+				store_file_name = optarg;
+				break;
+
+			case 'T':
+				stats_flag = true;
+				break;
+
+			case 'J':
+				stats_file_name = optarg;
+				break;
+
+			case 'H':
+				perf_flag = true;
+				break;
+
+			case 'c':
+				cache_size = atol( optarg );
+				break;
+
+			default:
+				cerr << "Unknown option	!" << endl;
+				exit( EXIT_FAILURE );
+		}
+
+	}
+
+	if ((stats_flag or (stats_file_name.size() != 0)) and !SEARCH_STATS) {
+		cerr << "error: the statistics are not compiled, build with 'make STATS=1'" << endl;
+		exit( EXIT_FAILURE );
+	}
+
+	if (perf_flag and !stats_flag and (stats_file_name.size() == 0)) {
+		cerr << "error: the hardware counters are printed with the statistics (--stats)" << endl;
+		exit( EXIT_FAILURE );
+	}
+
+	SearchStats_use_perf( perf_flag );
+
+	// results of the previous runs
+	PuzzleStore store;
+
+	if (store_file_name.size() != 0) {
+		if (!PuzzleStore_open( store, store_file_name.c_str() )) {
+			cerr << "error: could not open store '" << store_file_name << "'" << endl;
+			exit( EXIT_FAILURE );
+		}
+		options._store = &store;
+	}
+
+	// in batch mode only the results are printed
+	if (batch_file_name.size() != 0) {
+
+		if (solutions_file_name.size() != 0) {
+			cerr << "error: the solutions can't be written in batch mode" << endl;
+			exit( EXIT_FAILURE );
+		}
+
+		if (stats_flag or (stats_file_name.size() != 0)) {
+			cerr << "error: the statistics can't be printed in batch mode" << endl;
+			exit( EXIT_FAILURE );
+		}
+
+		// the grids that are transformations of a grid already solved
+		// are not solved again
+		ResultCache cache;
+		ResultCache_init( cache, cache_size );
+		if (cache_size > 0) options._cache = &cache;
+
+		bool stats_flag = (verbose_level >= 1);
+		verbose_level = 0;
+		print_first_flag = false;
+
+		if (batch_file_name == "-") {
+
+			Batch_solve( cin, cout, options, nbr_threads, ordered_flag, verify_flag );
+
+		} else {
+
+			PuzzleFile pf;
+
+			if (!PuzzleFile_open( pf, batch_file_name.c_str() )) {
+				cerr << "error: could not open file '" << batch_file_name << "'" << endl;
+				exit( EXIT_FAILURE );
+			}
+
+			Batch_solve( pf, cout, options, nbr_threads, ordered_flag, verify_flag );
+
+			PuzzleFile_close( pf );
+
+		}
+
+		if (stats_flag and (cache_size > 0)) {
+			cerr << "- cache hits=" << cache._nbr_hits << " misses=" << cache._nbr_misses << endl;
+		}
+
+		if (options._store != nullptr) {
+			if (stats_flag) {
+				cerr << "- store hits=" << store._nbr_hits << " misses=" << store._nbr_misses;
+				cerr << " refused=" << store._nbr_refused << endl;
+			}
+			if (store._nbr_refused > 0) {
+				cerr << "warning: " << store._nbr_refused << " result(s) could not be added to store '";
+				cerr << store_file_name << "'" << endl;
+			}
+			PuzzleStore_close( store );
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	// with -v 2 the solutions are printed on the standard output
+	if ((verbose_level >= 2) and (solutions_file_name.size() == 0)) {
+		solutions_file_name = "-";
+	}
+
+	Grid initial_grid;
+	SolverResult result;
+	result._nbr_solutions = 0;
+	result._stopped = false;
+
+	Grid_init( initial_grid );
+
+	// 2315 solutions
+	input =
+	"1 2 5 7 3 6 4 0 0 "
+	"0 0 0 0 1 8 5 0 0 "
+	"0 0 0 5 0 4 0 0 0 "
+	"0 0 0 0 5 0 0 2 0 "
+	"0 0 0 0 0 0 0 0 0 "
+	"0 0 0 2 7 0 0 0 0 "
+	"0 8 3 0 0 0 0 0 0 "
+	"0 0 0 6 0 2 3 9 0 "
+	"0 0 0 0 0 0 8 4 7 ";
+
+
+	bool read_flag = false;
+
+	if (input_file_name.size() != 0) {
+
+		cout << "- read file " << input_file_name << endl;
+
+		PuzzleFile pf;
+
+		if (PuzzleFile_open( pf, input_file_name.c_str() )) {
+
+			read_flag = PuzzleFile_next( pf, initial_grid );
+			PuzzleFile_close( pf );
+
+		}
+
+		if (!read_flag) {
+			cout << "error: could not read grid from file '" << input_file_name << "'" << endl;
+		}
+
+	}
+
+	if (!read_flag) {
+		Grid_fill( initial_grid, input );
+	}
+
+	if (verbose_level >= 1) {
+		cout << endl;
+		cout << "- initial grid" << endl;
+		cout << initial_grid << endl;
+	}
+
+
+	int satisfiability = Grid_satisfied( initial_grid );
+	cout << endl;
+	cout << "- initial grid satisfied ? " << satisfied_strings[ satisfiability ] << endl;
+	cout << endl;
+
+	if (satisfiability == UNSATISFIED) {
+
+		cout << "Error: can't solve a grid that is already UNSATISFIED" << endl;
+
+	} else {
+
+		cout << endl;
+		cout << "- start search" << endl;
+
+		// the solver fills its buffer with the solutions and a writer
+		// thread writes the buffer to the file
+		SolutionWriter writer;
+		bool write_flag = (solutions_file_name.size() != 0);
+
+		if (write_flag and !SolutionWriter_open( writer, solutions_file_name.c_str(),
+				packed_flag ? SOLUTION_FORMAT_PACKED : SOLUTION_FORMAT_TEXT )) {
+			cout << "error: could not create file '" << solutions_file_name << "'" << endl;
+			exit( EXIT_FAILURE );
+		}
+
+		options._writer = write_flag ? &writer : nullptr;
+
+		Solver solver;
+		Solver_init( solver, options );
+		Solver_solve( solver, initial_grid, result );
+
+		if (stats_flag) {
+			cout << endl;
+			Solver_print_stats( solver, cout );
+		}
+
+		if (stats_file_name == "-") {
+			Solver_print_stats( solver, cout, true );
+		} else if (stats_file_name.size() != 0) {
+			ofstream out( stats_file_name.c_str() );
+			if (!out) {
+				cout << "error: could not create file '" << stats_file_name << "'" << endl;
+			} else {
+				Solver_print_stats( solver, out, true );
+			}
+		}
+
+		Solver_free( solver );
+
+		if (write_flag) {
+			if (!SolutionWriter_close( writer )) {
+				cout << "error: could not write solutions to '" << solutions_file_name << "'" << endl;
+			}
+		}
+
+		if (print_first_flag and (result._nbr_solutions > 0)) {
+			cout << "- first solution found:" << endl;
+			cout << result._first_solution << endl;
+		}
+
+	}
+
+	if (options._store != nullptr) {
+		if (store._nbr_refused > 0) {
+			cerr << "warning: the result could not be added to store '" << store_file_name << "'" << endl;
+		}
+		PuzzleStore_close( store );
+	}
+
+	cout << endl;
+	if (result._stats._store_hit) {
+		cout << "- result read from store '" << store_file_name << "'" << endl;
+	}
+	if (result._stopped) {
+		cout << "- search stopped after " << options._max_solutions << " solution(s)" << endl;
+	}
+	cout << "- number of solutions=" << result._nbr_solutions << endl;
+
+	return EXIT_SUCCESS;
+}
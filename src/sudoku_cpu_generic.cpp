@@ -0,0 +1,356 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+using namespace std;
+#include <getopt.h>
+#include "grid_n.h"
+#include "solver_n.h"
+#include "solver.h"
+#include "batch.h"
+
+// ==================================================================
+// GLOBAL VARIABLES
+// ==================================================================
+int verbose_level = 1;
+// the search stops after this number of solutions, 0 for all
+long max_solutions = 0;
+// options of the 9×9 grids which are solved by the Solver
+SolverOptions options;
+// threads of the batch of 9×9 grids
+int nbr_threads = 1;
+
+string satisfied_strings[] = {
+	"unsatisfied",
+	"almost",
+	"*** not defined ***",
+	"satisfied"
+};
+
+// 2315 solutions
+const char *default_input =
+	"1 2 5 7 3 6 4 0 0 "
+	"0 0 0 0 1 8 5 0 0 "
+	"0 0 0 5 0 4 0 0 0 "
+	"0 0 0 0 5 0 0 2 0 "
+	"0 0 0 0 0 0 0 0 0 "
+	"0 0 0 2 7 0 0 0 0 "
+	"0 8 3 0 0 0 0 0 0 "
+	"0 0 0 6 0 2 3 9 0 "
+	"0 0 0 0 0 0 8 4 7 ";
+
+/**
+ * Find the solutions of grid g with the search of the grids of any
+ * size
+ */
+template <int BOX>
+void solve( const GridN<BOX>& g, SolverNResult<BOX>& result ) {
+
+	SolverN_solve( g, max_solutions, result );
+
+}
+
+/**
+ * The 9×9 grids are solved by the Solver which has the limit, the
+ * cache, the store and several threads. Its sequential search with
+ * the MRV is the same search as for the other sizes. The nodes are
+ * not counted.
+ */
+template <>
+void solve<3>( const GridN<3>& g, SolverNResult<3>& result ) {
+
+	Grid grid;
+	GridN_to_grid( g, grid );
+
+	SolverResult r;
+	Solver solver;
+	Solver_init( solver, options );
+	Solver_solve( solver, grid, r );
+	Solver_free( solver );
+
+	result._nbr_solutions = r._nbr_solutions;
+	result._stopped = r._stopped;
+	result._nbr_nodes = 0;
+	result._time = r._stats._time;
+
+	for (int y = 1; y <= MAX_VAL; ++y) {
+		for (int x = 1; x <= MAX_VAL; ++x) {
+			GridN_set( result._first_solution, y, x, Grid_get( r._first_solution, y, x ) );
+		}
+	}
+
+}
+
+/**
+ * Solve the grids of the stream and print one line for each grid
+ * with the number of solutions followed by the first solution
+ */
+template <int BOX>
+void solve_batch( istream& in ) {
+
+	GridN<BOX> grid;
+	SolverNResult<BOX> result;
+
+	while (GridN_read( in, grid )) {
+
+		if (!SolverN_solve( grid, max_solutions, result )) {
+			result._nbr_solutions = 0;
+		}
+
+		cout << result._nbr_solutions;
+		if (result._nbr_solutions > 0) cout << " " << GridN_to_string( result._first_solution );
+		cout << '\n';
+	}
+
+}
+
+/**
+ * The 9×9 grids are solved by the batch of the other binaries
+ */
+template <>
+void solve_batch<3>( istream& in ) {
+
+	Batch_solve( in, cout, options, nbr_threads );
+
+}
+
+/**
+ * Solve the grid of the stream with the messages of the other binaries
+ */
+template <int BOX>
+void solve_grid( istream& in ) {
+
+	GridN<BOX> initial_grid;
+	SolverNResult<BOX> result;
+	result._nbr_solutions = 0;
+	result._stopped = false;
+
+	if (!GridN_read( in, initial_grid )) {
+		cout << "error: could not read grid of " << GridNTraits<BOX>::SIZE << "x"
+			<< GridNTraits<BOX>::SIZE << " cells" << endl;
+		exit( EXIT_FAILURE );
+	}
+
+	if (verbose_level >= 1) {
+		cout << endl;
+		cout << "- initial grid" << endl;
+		GridN_print( cout, initial_grid );
+	}
+
+	int satisfiability = GridN_satisfied( initial_grid );
+	cout << endl;
+	cout << "- initial grid satisfied ? " << satisfied_strings[ satisfiability ] << endl;
+
+	if (satisfiability == UNSATISFIED) {
+
+		cout << "Error: can't solve a grid that is already UNSATISFIED" << endl;
+
+	} else {
+
+		cout << endl;
+		cout << "- start search" << endl;
+
+		solve( initial_grid, result );
+
+		if ((verbose_level >= 1) and (result._nbr_solutions > 0)) {
+			cout << endl;
+			cout << "- first solution" << endl;
+			GridN_print( cout, result._first_solution );
+		}
+
+		if (verbose_level >= 1) {
+			cout << endl;
+			cout << "- ";
+			if (result._nbr_nodes > 0) cout << "nodes=" << result._nbr_nodes << " ";
+			cout << "time=" << result._time << "s" << endl;
+		}
+	}
+
+	cout << endl;
+	if (result._stopped) {
+		cout << "- search stopped after " << max_solutions << " solution(s)" << endl;
+	}
+	cout << "- number of solutions=" << result._nbr_solutions << endl;
+
+}
+
+/**
+ * Close the store and warn if results could not be added
+ */
+void close_store( PuzzleStore& store, string& name ) {
+
+	if (store._nbr_refused > 0) {
+		cerr << "warning: " << store._nbr_refused << " result(s) could not be added to store '";
+		cerr << name << "'" << endl;
+	}
+
+	PuzzleStore_close( store );
+
+}
+
+
+/**
+ * main function
+ *
+ */
+int main( int argc, char *argv[] ) {
+
+	string input_file_name;
+	string batch_file_name;
+	string store_file_name;
+	// size of the boxes of the grid
+	int box = 3;
+	// maximum number of results kept in the cache in batch mode
+	long cache_size = 0;
+
+	static struct option long_options[] = {
+
+		{ "verbose-level", required_argument, 0, 'v' },
+		{ "input", required_argument, 0, 'i' },
+		{ "box", required_argument, 0, 'x' },
+		{ "batch", required_argument, 0, 'B' },
+		{ "max-solutions", required_argument, 0, 'n' },
+		{ "threads", required_argument, 0, 't' },
+		{ "store", required_argument, 0, 'S' },
+		{ "cache", required_argument, 0, 'c' },
+		{ 0, 0, 0, 0 }
+
+	};
+
+	int option_index = 0;
+	while (true) {
+
+		int c = getopt_long( argc, argv, "v:i:x:B:n:t:S:c:", long_options, &option_index );
+
+		if (c == -1) break;
+
+		switch( c ) {
+			case 'v':
+				verbose_level = atoi( optarg );
+				break;
+
+			case 'i':
+				input_file_name = optarg;
+				break;
+
+			case 'x':
+				box = atoi( optarg );
+				break;
+
+			case 'B':
+				batch_file_name = optarg;
+				break;
+
+			case 'n':
+				max_solutions = atol( optarg );
+				break;
+
+			case 't':
+				nbr_threads = atoi( optarg );
+				break;
+
+			case 'S':
+				store_file_name = optarg;
+				break;
+
+			case 'c':
+				cache_size = atol( optarg );
+				break;
+
+			default:
+				cerr << "Unknown option	!" << endl;
+				exit( EXIT_FAILURE );
+		}
+
+	}
+
+	if ((box < 3) or (box > 5)) {
+		cerr << "error: the size of the boxes must be 3, 4 or 5" << endl;
+		exit( EXIT_FAILURE );
+	}
+
+	if ((box != 3) and ((store_file_name.size() != 0) or (cache_size > 0) or (nbr_threads > 1))) {
+		cerr << "error: the store, the cache and the threads are only used with --box 3" << endl;
+		exit( EXIT_FAILURE );
+	}
+
+	// the search of the grids of any size
+	SolverOptions_init( options );
+	options._engine = SOLVER_RECURSIVE;
+	options._mrv = true;
+	options._max_solutions = max_solutions;
+
+	// results of the previous runs
+	PuzzleStore store;
+
+	if (store_file_name.size() != 0) {
+		if (!PuzzleStore_open( store, store_file_name.c_str() )) {
+			cerr << "error: could not open store '" << store_file_name << "'" << endl;
+			exit( EXIT_FAILURE );
+		}
+		options._store = &store;
+	}
+
+	// the grids that are transformations of a grid already solved are
+	// not solved again
+	ResultCache cache;
+	ResultCache_init( cache, cache_size );
+	if (cache_size > 0) options._cache = &cache;
+
+	// in batch mode only the results are printed
+	if (batch_file_name.size() != 0) {
+
+		ifstream file;
+		istream *in = &cin;
+
+		if (batch_file_name != "-") {
+			file.open( batch_file_name.c_str() );
+			if (!file) {
+				cerr << "error: could not open file '" << batch_file_name << "'" << endl;
+				exit( EXIT_FAILURE );
+			}
+			in = &file;
+		}
+
+		switch( box ) {
+			case 3: solve_batch<3>( *in ); break;
+			case 4: solve_batch<4>( *in ); break;
+			case 5: solve_batch<5>( *in ); break;
+		}
+
+		if (options._store != nullptr) close_store( store, store_file_name );
+
+		return EXIT_SUCCESS;
+	}
+
+	ifstream file;
+	istringstream default_stream( default_input );
+	istream *in = &default_stream;
+
+	if (input_file_name.size() != 0) {
+
+		cout << "- read file " << input_file_name << endl;
+
+		file.open( input_file_name.c_str() );
+
+		if (!file) {
+			cout << "error: could not open file '" << input_file_name << "'" << endl;
+			exit( EXIT_FAILURE );
+		}
+
+		in = &file;
+
+	} else if (box != 3) {
+		cerr << "error: a grid of " << box * box << "x" << box * box << " cells must be given with --input" << endl;
+		exit( EXIT_FAILURE );
+	}
+
+	switch( box ) {
+		case 3: solve_grid<3>( *in ); break;
+		case 4: solve_grid<4>( *in ); break;
+		case 5: solve_grid<5>( *in ); break;
+	}
+
+	if (options._store != nullptr) close_store( store, store_file_name );
+
+	return EXIT_SUCCESS;
+}
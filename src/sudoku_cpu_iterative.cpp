@@ -7,16 +7,13 @@
 using namespace std;
 #include <getopt.h>
 #include "grid.h"
+#include "puzzle_file.h"
+#include "grid_kernels.h"
+#include "solver.h"
+#include "batch.h"
+#include "solution_writer.h"
 
 
-ostream& operator<<( ostream& out, Position& pos ) {
-	return Position_print( out, pos );
-}
-
-ostream& operator<<( ostream& out, PositionCost& pc ) {
-	return PositionCost_print( out, pc );
-}
-
 ostream& operator<<( ostream& out, Grid& grid ) {
 	return Grid_print( out, grid );
 }
@@ -24,9 +21,16 @@ ostream& operator<<( ostream& out, Grid& grid ) {
 // ==================================================================
 // GLOBAL VARIABLES
 // ==================================================================
-int nbr_solutions = 0;
 int verbose_level = 1;
-bool reverse_flag = false;
+// file where all the solutions are written, "-" for the standard output
+string solutions_file_name;
+bool packed_flag = false;
+string store_file_name;
+// print the statistics of the search, in JSON in the file
+bool stats_flag = false;
+string stats_file_name;
+// add the hardware counters to the statistics
+bool perf_flag = false;
 bool print_first_flag = false;
 
 string satisfied_strings[] = { 
@@ -37,74 +41,6 @@ string satisfied_strings[] = {
 };
 
 
-
-/**
- * Iteratively solve the Sudoku given the list of zero positions
- *
- */
-void Grid_solve_iterative( Grid& g, vector< PositionCost >& epc ) {
-
-	int m = static_cast<int>( epc.size() );
-	
-	int i = 0;
-	while (i < m) {
-		
-		if (i == m) {
-		
-			--i;
-			
-		} else {	
-			
-			int y = epc[ i ]._y;
-			int x = epc[ i ]._x;
-			++g[ y ][ x ];
-			
-			while (i > 0) {
-				if ( g[ y ][ x ] > MAX_VAL) {
-					g[ y ][ x ] = ZERO;
-					--i;
-					y = epc[ i ]._y;
-					x = epc[ i ]._x;
-					++g[ y ][ x ];
-				} else {
-					break;
-				}
-			}
-		}
-		
-		if ( g[ epc[ 0 ]._y ][ epc[ 0 ]._x ] > MAX_VAL) break;
-				
-		if ( Grid_satisfied( g ) != UNSATISFIED ) {
-			++i;
-		}
-				
-		if (i == m) {
-			
-			if ( Grid_satisfied( g ) == SATISFIED ) {
-				
-				++nbr_solutions;
-				if (nbr_solutions == 1) {
-					if (print_first_flag) {
-						cout << "- first solution found:" << endl;
-						cout << g << endl;
-					} else if (verbose_level >= 2) {
-						cout << g << endl;
-					}
-				} else {
-					if (verbose_level >= 2) {
-						cout << g << endl;
-					}
-				}
-			}
-			--i;		
-		}
-		
-		
-	}
-
-	
-}
-
 /**
  * main function
  *
@@ -113,13 +49,38 @@ int main( int argc, char *argv[] ) {
 
 	string input;
 	string input_file_name;
+	string batch_file_name;
+	int nbr_threads = 1;
+	bool ordered_flag = true;
+	bool verify_flag = false;
+	// maximum number of results kept in the cache in batch mode
+	long cache_size = 0;
+	// options of the search
+	SolverOptions options;
+	SolverOptions_init( options );
+	options._engine = SOLVER_ITERATIVE;
 		
 	static struct option long_options[] = {
 	
-		{ "verbose-level", required_argument, 0,  0 },
-		{ "input", required_argument, 0,  0 }, 
-		{ "reverse", no_argument, 0, 0 }, 
-		{ "print-first", no_argument, 0, 0 },
+		{ "verbose-level", required_argument, 0, 'v' },
+		{ "input", required_argument, 0, 'i' }, 
+		{ "kernel", required_argument, 0, 'k' },
+		{ "verify", no_argument, 0, 'V' },
+		{ "batch", required_argument, 0, 'B' },
+		{ "threads", required_argument, 0, 't' },
+		{ "unordered", no_argument, 0, 'u' },
+		{ "reverse", no_argument, 0, 'r' }, 
+		{ "print-first", no_argument, 0, 'f' },
+		{ "propagate", no_argument, 0, 'p' }, 
+		{ "mrv", no_argument, 0, 'm' }, 
+		{ "max-solutions", required_argument, 0, 'n' },
+		{ "solutions", required_argument, 0, 's' },
+		{ "packed", no_argument, 0, 'P' },
+		{ "store", required_argument, 0, 'S' },
+		{ "stats", no_argument, 0, 'T' },
+		{ "stats-json", required_argument, 0, 'J' },
+		{ "perf", no_argument, 0, 'H' },
+		{ "cache", required_argument, 0, 'c' },
 		{ 0, 0, 0, 0 }
 		
 	};
@@ -127,7 +88,7 @@ int main( int argc, char *argv[] ) {
 	int option_index = 0;
 	while (true) {
 	
-		int c = getopt_long( argc, argv, "v:i:rf", long_options, &option_index );
+		int c = getopt_long( argc, argv, "v:i:rfpmB:t:uk:Vn:s:PS:TJ:Hc:", long_options, &option_index );
 	
 		if (c == -1) break;
 
@@ -139,14 +100,77 @@ int main( int argc, char *argv[] ) {
 			case 'i':
 				input_file_name = optarg;
 				break;
+				
+			case 'k':
+				if (!Grid_select_kernel( optarg )) {
+					cerr << "error: kernel '" << optarg << "' is unknown or not supported" << endl;
+					exit( EXIT_FAILURE );
+				}
+				break;
+				
+			case 'V':
+				verify_flag = true;
+				break;
+				
+			case 'B':
+				batch_file_name = optarg;
+				break;
+					
+			case 't':
+				nbr_threads = atoi( optarg );
+				break;
+					
+			case 'u':
+				ordered_flag = false;
+				break;
 					
 			case 'r':
-				reverse_flag = true;
+				options._reverse = true;
 				break;
 				
 			case 'f':
 				print_first_flag = true;
 				break;	
+				
+			case 'p':
+				options._propagate = true;
+				break;
+				
+			case 'm':
+				options._mrv = true;
+				break;
+					
+			case 'n':
+				options._max_solutions = atol( optarg );
+				break;
+					
+			case 's':
+				solutions_file_name = optarg;
+				break;
+					
+			case 'P':
+				packed_flag = true;
+				break;
+					
+			case 'S':
+				store_file_name = optarg;
+				break;
+					
+			case 'T':
+				stats_flag = true;
+				break;
+					
+			case 'J':
+				stats_file_name = optarg;
+				break;
+					
+			case 'H':
+				perf_flag = true;
+				break;
+					
+			case 'c':
+				cache_size = atol( optarg );
+				break;
 					
 			default:
 				cerr << "Unknown option	!" << endl;
@@ -155,9 +179,101 @@ int main( int argc, char *argv[] ) {
 		
 	}
 		
+	if ((stats_flag or (stats_file_name.size() != 0)) and !SEARCH_STATS) {
+		cerr << "error: the statistics are not compiled, build with 'make STATS=1'" << endl;
+		exit( EXIT_FAILURE );
+	}
+	
+	if (perf_flag and !stats_flag and (stats_file_name.size() == 0)) {
+		cerr << "error: the hardware counters are printed with the statistics (--stats)" << endl;
+		exit( EXIT_FAILURE );
+	}
+	
+	SearchStats_use_perf( perf_flag );
+	
+	// results of the previous runs
+	PuzzleStore store;
+	
+	if (store_file_name.size() != 0) {
+		if (!PuzzleStore_open( store, store_file_name.c_str() )) {
+			cerr << "error: could not open store '" << store_file_name << "'" << endl;
+			exit( EXIT_FAILURE );
+		}
+		options._store = &store;
+	}
+	
+	// in batch mode only the results are printed
+	if (batch_file_name.size() != 0) {
+	
+		if (solutions_file_name.size() != 0) {
+			cerr << "error: the solutions can't be written in batch mode" << endl;
+			exit( EXIT_FAILURE );
+		}
+		
+		if (stats_flag or (stats_file_name.size() != 0)) {
+			cerr << "error: the statistics can't be printed in batch mode" << endl;
+			exit( EXIT_FAILURE );
+		}
+		
+		// the grids that are transformations of a grid already solved
+		// are not solved again
+		ResultCache cache;
+		ResultCache_init( cache, cache_size );
+		if (cache_size > 0) options._cache = &cache;
+		
+		bool stats_flag = (verbose_level >= 1);
+		verbose_level = 0;
+		print_first_flag = false;
+		
+		if (batch_file_name == "-") {
+		
+			Batch_solve( cin, cout, options, nbr_threads, ordered_flag, verify_flag );
+			
+		} else {
+		
+			PuzzleFile pf;
+			
+			if (!PuzzleFile_open( pf, batch_file_name.c_str() )) {
+				cerr << "error: could not open file '" << batch_file_name << "'" << endl;
+				exit( EXIT_FAILURE );
+			}
+			
+			Batch_solve( pf, cout, options, nbr_threads, ordered_flag, verify_flag );
+			
+			PuzzleFile_close( pf );
+			
+		}
+		
+		if (stats_flag and (cache_size > 0)) {
+			cerr << "- cache hits=" << cache._nbr_hits << " misses=" << cache._nbr_misses << endl;
+		}
+		
+		if (options._store != nullptr) {
+			if (stats_flag) {
+				cerr << "- store hits=" << store._nbr_hits << " misses=" << store._nbr_misses;
+				cerr << " refused=" << store._nbr_refused << endl;
+			}
+			if (store._nbr_refused > 0) {
+				cerr << "warning: " << store._nbr_refused << " result(s) could not be added to store '";
+				cerr << store_file_name << "'" << endl;
+			}
+			PuzzleStore_close( store );
+		}
+		
+		return EXIT_SUCCESS;
+	}
+	
+	// with -v 2 the solutions are printed on the standard output
+	if ((verbose_level >= 2) and (solutions_file_name.size() == 0)) {
+		solutions_file_name = "-";
+	}
+	
 	srand( time( nullptr ) );
 	
 	Grid initial_grid;
+	SolverResult result;
+	result._nbr_solutions = 0;
+	result._stopped = false;
 	
 	Grid_init( initial_grid );
 		
@@ -174,28 +290,30 @@ int main( int argc, char *argv[] ) {
 	"0 0 0 0 0 0 8 4 7 ";
 
 	
+	bool read_flag = false;
+	
 	if (input_file_name.size() != 0) {
-
+		
 		cout << "- read file " << input_file_name << endl;
 
-		ifstream ifs( input_file_name );
-				
-		if (ifs.is_open()) {
-
-			std::string str( (std::istreambuf_iterator<char>(ifs)),
-                 std::istreambuf_iterator<char>());
-                 
-            input = str;     
-
-		} else {
+		PuzzleFile pf;
 		
-			cout << "error: could not open file '" << input_file_name << "'" << endl;
+		if (PuzzleFile_open( pf, input_file_name.c_str() )) {
 			
+			read_flag = PuzzleFile_next( pf, initial_grid );
+			PuzzleFile_close( pf );
+				
+		}
+		
+		if (!read_flag) {
+			cout << "error: could not read grid from file '" << input_file_name << "'" << endl;
 		}
 		
 	}
 	
-	Grid_fill( initial_grid, input );
+	if (!read_flag) {
+		Grid_fill( initial_grid, input );
+	}
 	
 	if (verbose_level >= 1) {
 		cout << endl;
@@ -222,36 +340,72 @@ int main( int argc, char *argv[] ) {
 			
 	} else {
 	
-		// find all empty positions that need to be filled
-		vector< PositionCost > empty_positions_costs;
-		Grid_find_empty_positions_costs( initial_grid, empty_positions_costs );
+		cout << endl;
+		cout << "- start search" << endl;
+		
+		// the solver fills its buffer with the solutions and a writer
+		// thread writes the buffer to the file
+		SolutionWriter writer;
+		bool write_flag = (solutions_file_name.size() != 0);
+		
+		if (write_flag and !SolutionWriter_open( writer, solutions_file_name.c_str(),
+				packed_flag ? SOLUTION_FORMAT_PACKED : SOLUTION_FORMAT_TEXT )) {
+			cout << "error: could not create file '" << solutions_file_name << "'" << endl;
+			exit( EXIT_FAILURE );
+		}
 		
-		std::sort( empty_positions_costs.begin(), empty_positions_costs.end(), 
-			[]( PositionCost& a, PositionCost& b) {
-				return a._cost > b._cost;
-			} 
-		);
+		options._writer = write_flag ? &writer : nullptr;
 		
-		if (reverse_flag) {
-			std::reverse( empty_positions_costs.begin(), empty_positions_costs.end() );
+		Solver solver;
+		Solver_init( solver, options );
+		Solver_solve( solver, initial_grid, result );
+		
+		if (stats_flag) {
+			cout << endl;
+			Solver_print_stats( solver, cout );
 		}
 		
-		if (verbose_level >= 2) {
-			cout << "empty positions=" << empty_positions_costs.size() << endl;
-			for (auto pc : empty_positions_costs) {
-				cout << pc << endl;
+		if (stats_file_name == "-") {
+			Solver_print_stats( solver, cout, true );
+		} else if (stats_file_name.size() != 0) {
+			ofstream out( stats_file_name.c_str() );
+			if (!out) {
+				cout << "error: could not create file '" << stats_file_name << "'" << endl;
+			} else {
+				Solver_print_stats( solver, out, true );
 			}
 		}
 		
-		cout << endl;
-		cout << "- start search" << endl;
+		Solver_free( solver );
+		
+		if (write_flag) {
+			if (!SolutionWriter_close( writer )) {
+				cout << "error: could not write solutions to '" << solutions_file_name << "'" << endl;
+			}
+		}
 		
-		Grid_solve_iterative( initial_grid, empty_positions_costs );
+		if (print_first_flag and (result._nbr_solutions > 0)) {
+			cout << "- first solution found:" << endl;
+			cout << result._first_solution << endl;
+		}
 		
 	}	
 	
+	if (options._store != nullptr) {
+		if (store._nbr_refused > 0) {
+			cerr << "warning: the result could not be added to store '" << store_file_name << "'" << endl;
+		}
+		PuzzleStore_close( store );
+	}
+	
 	cout << endl;
-	cout << "- number of solutions=" << nbr_solutions << endl;
+	if (result._stats._store_hit) {
+		cout << "- result read from store '" << store_file_name << "'" << endl;
+	}
+	if (result._stopped) {
+		cout << "- search stopped after " << options._max_solutions << " solution(s)" << endl;
+	}
+	cout << "- number of solutions=" << result._nbr_solutions << endl;
 		
 	return EXIT_SUCCESS;
 }
@@ -6,17 +6,14 @@
 #include <algorithm>
 using namespace std;
 #include <getopt.h>
+#include <omp.h>
 #include "grid.h"
+#include "puzzle_file.h"
+#include "grid_kernels.h"
+#include "solver.h"
+#include "seed_generator.h"
 
 
-ostream& operator<<( ostream& out, Position& pos ) {
-	return Position_print( out, pos );
-}
-
-ostream& operator<<( ostream& out, PositionCost& pc ) {
-	return PositionCost_print( out, pc );
-}
-
 ostream& operator<<( ostream& out, BlockCost& bc ) {
 	return BlockCost_print( out, bc );
 }
@@ -28,10 +25,18 @@ ostream& operator<<( ostream& out, Grid& grid ) {
 // ==================================================================
 // GLOBAL VARIABLES
 // ==================================================================
-int nbr_solutions = 0;
 int verbose_level = 1;
-bool reverse_flag = false;
-int nbr_blocks = 1;
+// file where all the solutions are written, "-" for the standard output
+string solutions_file_name;
+bool packed_flag = false;
+string store_file_name;
+// print the statistics of the search, in JSON in the file
+bool stats_flag = false;
+string stats_file_name;
+// add the hardware counters to the statistics
+bool perf_flag = false;
+// select the number of blocks from the number of threads
+bool auto_split_flag = false;
 bool print_first_flag = false;
 
 string satisfied_strings[] = { 
@@ -42,150 +47,6 @@ string satisfied_strings[] = {
 };
 
 
-
-/**
- * Iteratively solve the Sudoku given the list of zero positions
- *
- */
-void Grid_solve_iterative_( int gtid, Grid& g, vector< Position >& ep ) {
-
-	int m = static_cast<int>( ep.size() );
-	
-	int i = 0;
-	while (i < m) {
-		
-		if (i == m) {
-		
-			--i;
-			
-		} else {	
-			
-			int y = ep[ i ]._y;
-			int x = ep[ i ]._x;
-			++g[ y ][ x ];
-			
-			while (i > 0) {
-				if ( g[ y ][ x ] > MAX_VAL) {
-					g[ y ][ x ] = ZERO;
-					--i;
-					y = ep[ i ]._y;
-					x = ep[ i ]._x;
-					++g[ y ][ x ];
-					
-				} else {
-					break;
-				}
-			}
-		}
-		
-		if ( g[ ep[ 0 ]._y ][ ep[ 0 ]._x ] > MAX_VAL) break;
-				
-		int sat = Grid_satisfied( g );
-		
-		if ( sat != UNSATISFIED ) {
-			++i;
-		}
-				
-		if (i == m) {
-			
-			if ( Grid_satisfied( g ) == SATISFIED ) {
-				
-				++nbr_solutions;
-				if (nbr_solutions == 1) {
-					if (print_first_flag) {
-						cout << "- first solution found:" << endl;
-						cout << g << endl;
-					} else if (verbose_level >= 2) {
-						cout << g << endl;
-					}
-				} else {
-					if (verbose_level >= 2) {
-						cout << g << endl;
-					}
-				}
-			}
-			--i;		
-		}
-		
-		
-	}
-	
-}
-
-
-
-
-/**
- * Iteratively solve the Sudoku given the list of zero positions
- *
- */
-void Grid_solve_iterative( int nbr_grids, Grid *tab_grids ) {
-
-	vector< Position > empty_positions;
-	
-	Grid_find_empty_positions( tab_grids[ 0 ], empty_positions );
-	
-	if (reverse_flag) {
-		reverse( empty_positions.begin(), empty_positions.end() );
-	}
-	
-	if (verbose_level >= 2) {
-		cout << "- empty positions=" << empty_positions.size() << endl;
-		for (auto p : empty_positions) {
-			cout << p << endl;
-		}
-	}
-
-	cout << endl;
-	cout << "- start search" << endl;
-	
-	#pragma omp parallel for
-	for ( int grid_id = 0; grid_id < nbr_grids; ++grid_id ) {
-	
-		Grid_solve_iterative_( grid_id, tab_grids[ grid_id ], 
-			empty_positions );
-			
-	}
-
-
-}
-
-
-/**
- * Recursively instantiate some cells
- *
- */
-void fill_grids( Grid *tab_grids, int nbr_blocks, 
-		vector< BlockCost >& blocks_costs, int& grid_id, int n ) {
-	
-	if ( n >= nbr_blocks ) {
-	
-		for (int i = 0; i < n; ++i) {
-
-			int block = blocks_costs[ i ]._block;
-			vector<int>& values = blocks_costs[ i ]._values;
-			
-			Grid_fill_block( tab_grids[ grid_id ], block, values );
-			
-		}
-		
-		++grid_id;
-		
-	} else {
-	
-		vector<int>& values = blocks_costs[ n ]._values;
-		
-		do {
-		
-			fill_grids( tab_grids, nbr_blocks, blocks_costs, grid_id, n + 1 );
-			
-		} while ( next_permutation( values.begin(), values.end() ) );
-		
-	}
-	
-}
-
-
 /**
  * main function
  *
@@ -194,14 +55,30 @@ int main( int argc, char *argv[] ) {
 
 	string input;
 	string input_file_name;
+	// options of the search
+	SolverOptions options;
+	SolverOptions_init( options );
+	options._engine = SOLVER_ITERATIVE;
+	options._parallel = true;
 		
 	static struct option long_options[] = {
 	
-		{ "verbose-level", required_argument, 0,  0 },
-		{ "input", required_argument, 0,  0 }, 
-		{ "blocks", required_argument, 0,  0 }, 
-		{ "reverse", no_argument, 0, 0 }, 
-		{ "print-first", no_argument, 0, 0 },
+		{ "verbose-level", required_argument, 0, 'v' },
+		{ "input", required_argument, 0, 'i' }, 
+		{ "kernel", required_argument, 0, 'k' },
+		{ "blocks", required_argument, 0, 'b' }, 
+		{ "auto-split", no_argument, 0, 'a' },
+		{ "frontier", required_argument, 0, 'F' },
+		{ "reverse", no_argument, 0, 'r' }, 
+		{ "work-stealing", no_argument, 0, 'w' }, 
+		{ "print-first", no_argument, 0, 'f' },
+		{ "max-solutions", required_argument, 0, 'n' },
+		{ "solutions", required_argument, 0, 's' },
+		{ "packed", no_argument, 0, 'P' },
+		{ "store", required_argument, 0, 'S' },
+		{ "stats", no_argument, 0, 'T' },
+		{ "stats-json", required_argument, 0, 'J' },
+		{ "perf", no_argument, 0, 'H' },
 		{ 0, 0, 0, 0 }
 		
 	};
@@ -209,7 +86,7 @@ int main( int argc, char *argv[] ) {
 	int option_index = 0;
 	while (true) {
 	
-		int c = getopt_long( argc, argv, "v:i:b:rf", long_options, &option_index );
+		int c = getopt_long( argc, argv, "v:i:b:rfwk:n:s:PS:TJ:HaF:", long_options, &option_index );
 	
 		if (c == -1) break;
 
@@ -222,28 +99,106 @@ int main( int argc, char *argv[] ) {
 				input_file_name = optarg;
 				break;
 					
+			case 'k':
+				if (!Grid_select_kernel( optarg )) {
+					cerr << "error: kernel '" << optarg << "' is unknown or not supported" << endl;
+					exit( EXIT_FAILURE );
+				}
+				break;
+					
 			case 'r':
-				reverse_flag = true;
+				options._reverse = true;
 				break;
 				
 			case 'b':
-				nbr_blocks = atoi( optarg );
+				options._nbr_blocks = atoi( optarg );
 				break;	
+				
+			case 'a':
+				auto_split_flag = true;
+				break;
+				
+			case 'F':
+				options._frontier = atol( optarg );
+				break;
+				
+			case 'w':
+				options._work_stealing = true;
+				break;
 			
 			case 'f': 
 				print_first_flag = true;
 				break;
 				
+			case 'n':
+				options._max_solutions = atol( optarg );
+				break;
+					
+			case 's':
+				solutions_file_name = optarg;
+				break;
+					
+			case 'P':
+				packed_flag = true;
+				break;
+				
+			case 'S':
+				store_file_name = optarg;
+				break;
+				
+			case 'T':
+				stats_flag = true;
+				break;
+				
+			case 'J':
+				stats_file_name = optarg;
+				break;
+				
+			case 'H':
+				perf_flag = true;
+				break;
+				
 			default:
 				cerr << "Unknown option	!" << endl;
 				exit( EXIT_FAILURE );
 		}
 		
 	}
+	
+	if ((stats_flag or (stats_file_name.size() != 0)) and !SEARCH_STATS) {
+		cerr << "! error: the statistics are not compiled, build with 'make STATS=1'" << endl;
+		exit( EXIT_FAILURE );
+	}
+	
+	if (perf_flag and !stats_flag and (stats_file_name.size() == 0)) {
+		cerr << "! error: the hardware counters are printed with the statistics (--stats)" << endl;
+		exit( EXIT_FAILURE );
+	}
+	
+	SearchStats_use_perf( perf_flag );
+	
+	// results of the previous runs
+	PuzzleStore store;
+	
+	if (store_file_name.size() != 0) {
+		if (!PuzzleStore_open( store, store_file_name.c_str() )) {
+			cerr << "! error: could not open store '" << store_file_name << "'" << endl;
+			exit( EXIT_FAILURE );
+		}
+		options._store = &store;
+	}
+	
+	// with -v 2 the solutions are printed on the standard output
+	if ((verbose_level >= 2) and (solutions_file_name.size() == 0)) {
+		solutions_file_name = "-";
+	}
 		
 	srand( time( nullptr ) );
 	
 	Grid initial_grid;
+	SolverResult result;
+	result._nbr_solutions = 0;
+	result._stopped = false;
 	
 	Grid_init( initial_grid );
 		
@@ -259,28 +214,30 @@ int main( int argc, char *argv[] ) {
 	"0 0 0 6 0 2 3 9 0 "
 	"0 0 0 0 0 0 8 4 7 ";
 	
-	if (input_file_name.size() != 0) {
+	bool read_flag = false;
 	
+	if (input_file_name.size() != 0) {
+		
 		cout << "- read file " << input_file_name << endl;
 
-		ifstream ifs( input_file_name );
-				
-		if (ifs.is_open()) {
-
-			std::string str( (std::istreambuf_iterator<char>(ifs)),
-                 std::istreambuf_iterator<char>());
-                 
-            input = str;     
-
-		} else {
+		PuzzleFile pf;
 		
-			cout << "error: could not open file '" << input_file_name << "'" << endl;
+		if (PuzzleFile_open( pf, input_file_name.c_str() )) {
 			
+			read_flag = PuzzleFile_next( pf, initial_grid );
+			PuzzleFile_close( pf );
+				
+		}
+		
+		if (!read_flag) {
+			cout << "error: could not read grid from file '" << input_file_name << "'" << endl;
 		}
 		
 	}
 	
-	Grid_fill( initial_grid, input );
+	if (!read_flag) {
+		Grid_fill( initial_grid, input );
+	}
 	
 	if (verbose_level >= 1) {
 		cout << endl;
@@ -302,99 +259,149 @@ int main( int argc, char *argv[] ) {
 	
 		vector< BlockCost > blocks_costs;
 		
-		for (int block = MIN_VAL; block <= MAX_VAL; ++block) {
-			BlockCost bc;
-			bc._block = block;
-			bc._permutations = 0;
-			bc._cost = Grid_block_nbr_values_set( initial_grid, block, bc._values );
-			
-			if (Grid_blk_satisfied( initial_grid, block ) != SATISFIED) {
-			
-				blocks_costs.push_back( bc );
-				
-			}
-		}
-		
-		// sort by most constrained block
-		std::sort( blocks_costs.begin(), blocks_costs.end(), []( BlockCost& a, BlockCost& b) {
-			return a._cost > b._cost;
-		} );	
+		Solver_blocks_costs( initial_grid, blocks_costs );
 		
 		//
 		// By using 'nbr_blocks' and their permutations, 
 		// we estimate the number of grids to use and fill
 		//
 				
-		cout << "- evaluate number of permutations:" << endl;
+		// the tasks are the nodes of the frontier of the search tree
+		if (options._frontier > 0) {
+		
+			cout << "- frontier of at least " << options._frontier << " node(s)" << endl;
+			
+		} else {
+		
+			if (auto_split_flag) {
+				int nbr_threads = (options._nbr_threads > 0) ? options._nbr_threads : omp_get_max_threads();
+				options._nbr_blocks = SeedGenerator_select_blocks( initial_grid, blocks_costs,
+					static_cast<uint64_t>( nbr_threads ) * SEEDS_PER_THREAD );
+				cout << "- automatic split for " << nbr_threads << " thread(s) with ";
+				cout << options._nbr_blocks << " block(s)" << endl;
+				cout << endl;
+			}
+		
+			cout << "- evaluate number of permutations:" << endl;
 				
-		int total_permutations = 1;
+			int nbr_blocks = std::min( options._nbr_blocks, static_cast<int>( blocks_costs.size() ) );
+		
+			uint64_t total_permutations = 1;
 		
-		for (int i = 0; i < nbr_blocks; ++i) {
+			for (int i = 0; i < nbr_blocks; ++i) {
 		
-			int nbr_permutations = 0;		
+				int nbr_permutations = 0;		
 			
-			std::vector<int>& values = blocks_costs[ i ]._values;
+				std::vector<int>& values = blocks_costs[ i ]._values;
 			
-			do {
+				do {
 			
-				++nbr_permutations;
+					++nbr_permutations;
 				
-			} while (next_permutation( values.begin(), values.end()));
+				} while (next_permutation( values.begin(), values.end()));
 		
-			if (verbose_level >= 1) {
-				cout << "-- number of permutations for block " << blocks_costs[ i ]._block;
-				cout << " = " << nbr_permutations << endl;		
-			}
+				if (verbose_level >= 1) {
+					cout << "-- number of permutations for block " << blocks_costs[ i ]._block;
+					cout << " = " << nbr_permutations << endl;		
+				}
 			
-			blocks_costs[ i ]._permutations = nbr_permutations;
+				blocks_costs[ i ]._permutations = nbr_permutations;
 			
-			total_permutations *= nbr_permutations;
-		}
+				total_permutations *= nbr_permutations;
+			}
 		
-		if (verbose_level >= 2) {
-			cout << "blocks costs=" << blocks_costs.size() << endl;
-			for (auto bc : blocks_costs) {
-				cout << bc << endl;
+			if (verbose_level >= 2) {
+				cout << "blocks costs=" << blocks_costs.size() << endl;
+				for (auto bc : blocks_costs) {
+					cout << bc << endl;
+				}
 			}
-		}
 		
-		cout << "- total number of permutations with " << nbr_blocks << " block(s) = ";
-		cout << total_permutations << endl;;
+			cout << "- total number of permutations with " << nbr_blocks << " block(s) = ";
+			cout << total_permutations << endl;;
+		}
 		
 	
 		//
-		// Now we create the grids from the initial grid and fill them
+		// The seed grids are generated on demand from the initial grid,
+		// only the grids that don't violate the constraints are kept
 		//
 		
-		Grid *tab_grids = new Grid[ total_permutations ];
-		for (int i = 0; i < total_permutations; ++i) {
-			Grid_copy( tab_grids[ i ], initial_grid );
+		cout << endl;
+		cout << "- start search" << endl;
+		
+		// the threads fill their buffers with their solutions and a
+		// writer thread writes the buffers to the file
+		SolutionWriter writer;
+		bool write_flag = (solutions_file_name.size() != 0);
+		
+		if (write_flag and !SolutionWriter_open( writer, solutions_file_name.c_str(),
+				packed_flag ? SOLUTION_FORMAT_PACKED : SOLUTION_FORMAT_TEXT )) {
+			cout << "! error: could not create file '" << solutions_file_name << "'" << endl;
+			exit( EXIT_FAILURE );
 		}
 		
-		int grid_id = 0;
+		options._writer = write_flag ? &writer : nullptr;
 		
-		fill_grids( tab_grids, nbr_blocks, blocks_costs, grid_id, 0 );
+		Solver solver;
+		Solver_init( solver, options );
+		Solver_solve( solver, initial_grid, result );
 		
-		if (verbose_level >= 2) {
-
-			cout << "- all grids" << endl;
-			
-			for (int i = 0; i < total_permutations; ++i) {
-			
-				cout << i << endl << tab_grids[ i ] << endl;
+		if (stats_flag) {
+			cout << endl;
+			Solver_print_stats( solver, cout );
+		}
+		
+		if (stats_file_name == "-") {
+			Solver_print_stats( solver, cout, true );
+		} else if (stats_file_name.size() != 0) {
+			ofstream out( stats_file_name.c_str() );
+			if (!out) {
+				cout << "! error: could not create file '" << stats_file_name << "'" << endl;
+			} else {
+				Solver_print_stats( solver, out, true );
 			}
+		}
 		
-		}	
+		Solver_free( solver );
 		
-		cout << endl;
-		cout << "- start search" << endl;
-			
-		Grid_solve_iterative( total_permutations, tab_grids );
+		if (write_flag and !SolutionWriter_close( writer )) {
+			cout << "! error: could not write solutions to '" << solutions_file_name << "'" << endl;
+		}
+		
+		if ((verbose_level >= 2) and options._work_stealing) {
+			cout << "- work stealing nodes=" << result._stats._nbr_nodes;
+			cout << " steals=" << result._stats._nbr_steals << endl;
+		}
+		
+		if (print_first_flag and (result._nbr_solutions > 0)) {
+			cout << "- first solution found:" << endl;
+			cout << result._first_solution << endl;
+		}
+		
+		if (options._frontier > 0) {
+			cout << "- number of grids of the frontier=" << result._stats._nbr_seeds << endl;
+		} else {
+			cout << "- number of seed grids=" << result._stats._nbr_seeds << endl;
+		}
 		
 	}	
 		
-	cout << endl;	
-	cout << "- number of solutions=" << nbr_solutions << endl;
+	if (options._store != nullptr) {
+		if (store._nbr_refused > 0) {
+			cerr << "warning: the result could not be added to store '" << store_file_name << "'" << endl;
+		}
+		PuzzleStore_close( store );
+	}
+	
+	cout << endl;
+	if (result._stats._store_hit) {
+		cout << "- result read from store '" << store_file_name << "'" << endl;
+	}
+	if (result._stopped) {
+		cout << "- search stopped after " << options._max_solutions << " solution(s)" << endl;
+	}
+	cout << "- number of solutions=" << result._nbr_solutions << endl;
 		
 	return EXIT_SUCCESS;
 }
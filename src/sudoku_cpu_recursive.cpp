@@ -7,16 +7,13 @@
 using namespace std;
 #include <getopt.h>
 #include "grid.h"
+#include "puzzle_file.h"
+#include "grid_kernels.h"
+#include "solver.h"
+#include "batch.h"
+#include "solution_writer.h"
 
 
-ostream& operator<<( ostream& out, Position& pos ) {
-	return Position_print( out, pos );
-}
-
-ostream& operator<<( ostream& out, PositionCost& pc ) {
-	return PositionCost_print( out, pc );
-}
-
 ostream& operator<<( ostream& out, BlockCost& bc ) {
 	return BlockCost_print( out, bc );
 }
@@ -28,9 +25,16 @@ ostream& operator<<( ostream& out, Grid& grid ) {
 // ==================================================================
 // GLOBAL VARIABLES
 // ==================================================================
-int nbr_solutions = 0;
 int verbose_level = 1;
-bool reverse_flag = false;
+// file where all the solutions are written, "-" for the standard output
+string solutions_file_name;
+bool packed_flag = false;
+string store_file_name;
+// print the statistics of the search, in JSON in the file
+bool stats_flag = false;
+string stats_file_name;
+// add the hardware counters to the statistics
+bool perf_flag = false;
 
 string satisfied_strings[] = { 
 	"unsatisfied", 
@@ -40,43 +44,6 @@ string satisfied_strings[] = {
 };
 
 
-
-/**
- * Recursively solve the Sudoku given the list of zero positions
- *
- */
-void Grid_solve_recursive( Grid& g, vector<PositionCost>& epc, int n = 0 ) {
-
-	if (n == static_cast<int>( epc.size() ) ) {
-	
-		if (Grid_satisfied( g ) == SATISFIED) {
-
-			if (verbose_level >= 2) cout << g << endl;
-			++nbr_solutions;
-
-		}
-	
-	} else {
-	
-		PositionCost pc = epc[ n ];
-		
-		for (GridElementType v = MIN_VAL; v <= MAX_VAL; ++v ) {
-		
-			g[ pc._y ][ pc._x ] = v;
-			
-			if (Grid_satisfied( g ) != UNSATISFIED) {
-				
-				Grid_solve_recursive( g, epc, n + 1 );
-			
-			}
-			
-			g[ pc._y ][ pc._x ] = ZERO;
-			
-		}
-	}
-
-}
-
 /**
  * main function
  *
@@ -85,12 +52,37 @@ int main( int argc, char *argv[] ) {
 
 	string input;
 	string input_file_name;
+	string batch_file_name;
+	int nbr_threads = 1;
+	bool ordered_flag = true;
+	bool verify_flag = false;
+	// maximum number of results kept in the cache in batch mode
+	long cache_size = 0;
+	// options of the search
+	SolverOptions options;
+	SolverOptions_init( options );
+	options._engine = SOLVER_RECURSIVE;
 		
 	static struct option long_options[] = {
 	
-		{ "verbose-level", required_argument, 0,  0 },
-		{ "input", required_argument, 0,  0 }, 
-		{ "reverse", no_argument, 0, 0 }, 
+		{ "verbose-level", required_argument, 0, 'v' },
+		{ "input", required_argument, 0, 'i' }, 
+		{ "kernel", required_argument, 0, 'k' },
+		{ "verify", no_argument, 0, 'V' },
+		{ "batch", required_argument, 0, 'B' },
+		{ "threads", required_argument, 0, 't' },
+		{ "unordered", no_argument, 0, 'u' },
+		{ "reverse", no_argument, 0, 'r' }, 
+		{ "propagate", no_argument, 0, 'p' }, 
+		{ "mrv", no_argument, 0, 'm' }, 
+		{ "max-solutions", required_argument, 0, 'n' },
+		{ "solutions", required_argument, 0, 's' },
+		{ "packed", no_argument, 0, 'P' },
+		{ "store", required_argument, 0, 'S' },
+		{ "stats", no_argument, 0, 'T' },
+		{ "stats-json", required_argument, 0, 'J' },
+		{ "perf", no_argument, 0, 'H' },
+		{ "cache", required_argument, 0, 'c' },
 		{ 0, 0, 0, 0 }
 		
 	};
@@ -98,7 +90,7 @@ int main( int argc, char *argv[] ) {
 	int option_index = 0;
 	while (true) {
 	
-		int c = getopt_long( argc, argv, "v:i:r", long_options, &option_index );
+		int c = getopt_long( argc, argv, "v:i:rpmB:t:uk:Vn:s:PS:TJ:Hc:", long_options, &option_index );
 	
 		if (c == -1) break;
 
@@ -110,9 +102,72 @@ int main( int argc, char *argv[] ) {
 			case 'i':
 				input_file_name = optarg;
 				break;
+				
+			case 'k':
+				if (!Grid_select_kernel( optarg )) {
+					cerr << "error: kernel '" << optarg << "' is unknown or not supported" << endl;
+					exit( EXIT_FAILURE );
+				}
+				break;
+				
+			case 'V':
+				verify_flag = true;
+				break;
+				
+			case 'B':
+				batch_file_name = optarg;
+				break;
+					
+			case 't':
+				nbr_threads = atoi( optarg );
+				break;
+					
+			case 'u':
+				ordered_flag = false;
+				break;
 					
 			case 'r':
-				reverse_flag = true;
+				options._reverse = true;
+				break;
+				
+			case 'p':
+				options._propagate = true;
+				break;
+				
+			case 'm':
+				options._mrv = true;
+				break;
+					
+			case 'n':
+				options._max_solutions = atol( optarg );
+				break;
+					
+			case 's':
+				solutions_file_name = optarg;
+				break;
+					
+			case 'P':
+				packed_flag = true;
+				break;
+					
+			case 'S':
+				store_file_name = optarg;
+				break;
+					
+			case 'T':
+				stats_flag = true;
+				break;
+					
+			case 'J':
+				stats_file_name = optarg;
+				break;
+					
+			case 'H':
+				perf_flag = true;
+				break;
+					
+			case 'c':
+				cache_size = atol( optarg );
 				break;
 					
 			default:
@@ -122,9 +177,100 @@ int main( int argc, char *argv[] ) {
 		
 	}
 		
+	if ((stats_flag or (stats_file_name.size() != 0)) and !SEARCH_STATS) {
+		cerr << "error: the statistics are not compiled, build with 'make STATS=1'" << endl;
+		exit( EXIT_FAILURE );
+	}
+	
+	if (perf_flag and !stats_flag and (stats_file_name.size() == 0)) {
+		cerr << "error: the hardware counters are printed with the statistics (--stats)" << endl;
+		exit( EXIT_FAILURE );
+	}
+	
+	SearchStats_use_perf( perf_flag );
+	
+	// results of the previous runs
+	PuzzleStore store;
+	
+	if (store_file_name.size() != 0) {
+		if (!PuzzleStore_open( store, store_file_name.c_str() )) {
+			cerr << "error: could not open store '" << store_file_name << "'" << endl;
+			exit( EXIT_FAILURE );
+		}
+		options._store = &store;
+	}
+	
+	// in batch mode only the results are printed
+	if (batch_file_name.size() != 0) {
+	
+		if (solutions_file_name.size() != 0) {
+			cerr << "error: the solutions can't be written in batch mode" << endl;
+			exit( EXIT_FAILURE );
+		}
+		
+		if (stats_flag or (stats_file_name.size() != 0)) {
+			cerr << "error: the statistics can't be printed in batch mode" << endl;
+			exit( EXIT_FAILURE );
+		}
+		
+		// the grids that are transformations of a grid already solved
+		// are not solved again
+		ResultCache cache;
+		ResultCache_init( cache, cache_size );
+		if (cache_size > 0) options._cache = &cache;
+		
+		bool stats_flag = (verbose_level >= 1);
+		verbose_level = 0;
+		
+		if (batch_file_name == "-") {
+		
+			Batch_solve( cin, cout, options, nbr_threads, ordered_flag, verify_flag );
+			
+		} else {
+		
+			PuzzleFile pf;
+			
+			if (!PuzzleFile_open( pf, batch_file_name.c_str() )) {
+				cerr << "error: could not open file '" << batch_file_name << "'" << endl;
+				exit( EXIT_FAILURE );
+			}
+			
+			Batch_solve( pf, cout, options, nbr_threads, ordered_flag, verify_flag );
+			
+			PuzzleFile_close( pf );
+			
+		}
+		
+		if (stats_flag and (cache_size > 0)) {
+			cerr << "- cache hits=" << cache._nbr_hits << " misses=" << cache._nbr_misses << endl;
+		}
+		
+		if (options._store != nullptr) {
+			if (stats_flag) {
+				cerr << "- store hits=" << store._nbr_hits << " misses=" << store._nbr_misses;
+				cerr << " refused=" << store._nbr_refused << endl;
+			}
+			if (store._nbr_refused > 0) {
+				cerr << "warning: " << store._nbr_refused << " result(s) could not be added to store '";
+				cerr << store_file_name << "'" << endl;
+			}
+			PuzzleStore_close( store );
+		}
+		
+		return EXIT_SUCCESS;
+	}
+	
+	// with -v 2 the solutions are printed on the standard output
+	if ((verbose_level >= 2) and (solutions_file_name.size() == 0)) {
+		solutions_file_name = "-";
+	}
+	
 	srand( time( nullptr ) );
 	
 	Grid initial_grid;
+	SolverResult result;
+	result._nbr_solutions = 0;
+	result._stopped = false;
 	
 	Grid_init( initial_grid );
 		
@@ -141,28 +287,30 @@ int main( int argc, char *argv[] ) {
 	"0 0 0 0 0 0 8 4 7 ";
 
 	
+	bool read_flag = false;
+	
 	if (input_file_name.size() != 0) {
 		
 		cout << "- read file " << input_file_name << endl;
 
-		ifstream ifs( input_file_name );
-				
-		if (ifs.is_open()) {
-
-			std::string str( (std::istreambuf_iterator<char>(ifs)),
-                 std::istreambuf_iterator<char>());
-                 
-            input = str;     
-
-		} else {
+		PuzzleFile pf;
 		
-			cout << "error: could not open file '" << input_file_name << "'" << endl;
+		if (PuzzleFile_open( pf, input_file_name.c_str() )) {
 			
+			read_flag = PuzzleFile_next( pf, initial_grid );
+			PuzzleFile_close( pf );
+				
+		}
+		
+		if (!read_flag) {
+			cout << "error: could not read grid from file '" << input_file_name << "'" << endl;
 		}
 		
 	}
 	
-	Grid_fill( initial_grid, input );
+	if (!read_flag) {
+		Grid_fill( initial_grid, input );
+	}
 	
 	if (verbose_level >= 1) {
 		cout << endl;
@@ -181,35 +329,67 @@ int main( int argc, char *argv[] ) {
 			
 	} else {
 	
-		vector< PositionCost > empty_positions_costs;
-		Grid_find_empty_positions_costs( initial_grid, empty_positions_costs );
+		cout << endl;
+		cout << "- start search" << endl;
+		
+		// the solver fills its buffer with the solutions and a writer
+		// thread writes the buffer to the file
+		SolutionWriter writer;
+		bool write_flag = (solutions_file_name.size() != 0);
+		
+		if (write_flag and !SolutionWriter_open( writer, solutions_file_name.c_str(),
+				packed_flag ? SOLUTION_FORMAT_PACKED : SOLUTION_FORMAT_TEXT )) {
+			cout << "error: could not create file '" << solutions_file_name << "'" << endl;
+			exit( EXIT_FAILURE );
+		}
 		
-		std::sort( empty_positions_costs.begin(), empty_positions_costs.end(), 
-			[]( PositionCost& a, PositionCost& b) {
-				return a._cost > b._cost;
-			} 
-		);
+		options._writer = write_flag ? &writer : nullptr;
 		
-		if (reverse_flag) {
-			std::reverse( empty_positions_costs.begin(), empty_positions_costs.end() );
+		Solver solver;
+		Solver_init( solver, options );
+		Solver_solve( solver, initial_grid, result );
+		
+		if (stats_flag) {
+			cout << endl;
+			Solver_print_stats( solver, cout );
 		}
 		
-		if (verbose_level >= 2) {
-			cout << "empty positions=" << empty_positions_costs.size() << endl;
-			for (auto pc : empty_positions_costs) {
-				cout << pc << endl;
+		if (stats_file_name == "-") {
+			Solver_print_stats( solver, cout, true );
+		} else if (stats_file_name.size() != 0) {
+			ofstream out( stats_file_name.c_str() );
+			if (!out) {
+				cout << "error: could not create file '" << stats_file_name << "'" << endl;
+			} else {
+				Solver_print_stats( solver, out, true );
 			}
 		}
 		
-		cout << endl;
-		cout << "- start search" << endl;
+		Solver_free( solver );
 		
-		Grid_solve_recursive( initial_grid, empty_positions_costs );
+		if (write_flag) {
+			if (!SolutionWriter_close( writer )) {
+				cout << "error: could not write solutions to '" << solutions_file_name << "'" << endl;
+			}
+		}
 		
 	}	
 		
-	cout << endl;	
-	cout << "- number of solutions=" << nbr_solutions << endl;
+	if (options._store != nullptr) {
+		if (store._nbr_refused > 0) {
+			cerr << "warning: the result could not be added to store '" << store_file_name << "'" << endl;
+		}
+		PuzzleStore_close( store );
+	}
+	
+	cout << endl;
+	if (result._stats._store_hit) {
+		cout << "- result read from store '" << store_file_name << "'" << endl;
+	}
+	if (result._stopped) {
+		cout << "- search stopped after " << options._max_solutions << " solution(s)" << endl;
+	}
+	cout << "- number of solutions=" << result._nbr_solutions << endl;
 		
 	return EXIT_SUCCESS;
 }
@@ -8,6 +8,10 @@
 using namespace std;
 #include <getopt.h>
 #include "grid.h"
+#include "puzzle_file.h"
+#include "grid_kernels.h"
+#include "seed_generator.h"
+#include "frontier.h"
 
 
 #include "gpu_grid.cu"
@@ -77,8 +81,18 @@ ostream& operator<<( ostream& out, Grid& grid ) {
 // ==================================================================
 int nbr_solutions = 0;
 int verbose_level = 1;
+// maximum number of solutions to find, 0 to find all solutions
+long max_solutions = 0;
+// true if the limit of solutions stopped the search while there were
+// branches or seed grids left to explore
+bool cut_flag = false;
 bool reverse_flag = false;
 int nbr_blocks = 1;
+// select the number of blocks from the number of threads of the GPU
+bool auto_split_flag = false;
+// if not 0, the tasks are the grids of the frontier of the search
+// tree with at least this number of nodes instead of the seed grids
+size_t frontier_size = 0;
 bool print_first_flag = false;
 
 string satisfied_strings[] = { 
@@ -91,68 +105,100 @@ string satisfied_strings[] = {
 extern __device__ int GPU_Grid_satisfied( Grid *g );
 
 /**
- * Iteratively solve the Sudoku given the list of zero positions
+ * Iteratively solve the Sudoku given the list of zero positions.
+ *
+ * The state of the constraints is kept in the registers / local
+ * memory of the thread so that each move only checks the row,
+ * column and block of the position.
+ *
+ * If max_solutions is not 0, the solutions found by all threads are
+ * counted in *nbr_found and the threads stop when the count reaches
+ * max_solutions. The count is polled every GPU_POLL_PERIOD moves.
+ * *cut is set if the thread stops with branches left to explore:
+ * after the last solution allowed the search goes on only until it
+ * finds a value to place (a branch left) or exhausts its tree.
  *
  */
+const int GPU_POLL_PERIOD = 256;
+
 __device__
 int device_Grid_solve_iterative( int gtid, 
 	Grid& g, 
 	int *tab_nbr_solutions,
 	int nbr_positions, 
-	Position* tab_positions ) {
+	Position* tab_positions,
+	int *nbr_found,
+	int *cut,
+	int max_solutions ) {
 	
 	int nb_sol = 0;
+	int nbr_moves = 0;
+	// the last solution allowed was found
+	bool limit = false;
+	
+	// the permutations of the blocks can violate the constraints
+	// of the rows or columns, such grids have no solution
+	GridState s;
+	if (GPU_GridState_init( s, g ) == UNSATISFIED) return nb_sol;
 	 
 	int m = nbr_positions; 
 	
 	int i = 0;
-	while (i < m) {
+	while (i >= 0) {
+	
+		if (!limit and (max_solutions != 0) and ((++nbr_moves % GPU_POLL_PERIOD) == 0)
+				and (*((volatile int *) nbr_found) >= max_solutions)) {
+			*cut = 1;
+			break;
+		}
 				
 		if (i == m) {
-		
-			--i;
-			
-		} else {	
 			
-			int y = tab_positions[ i ]._y;
-			int x = tab_positions[ i ]._x;
-			++g[ y ][ x ];
-			
-			
-			bool exit_loop = false;
-			while ((i > 0) and (exit_loop == false)) {
-				if ( g[ y ][ x ] > MAX_VAL) {
-					g[ y ][ x ] = 0;
-					--i;
-					y = tab_positions[ i ]._y;
-					x = tab_positions[ i ]._x;
-			
-					++g[ y ][ x ];
-				} else {
-					exit_loop = true;
+			if ( GPU_GridState_satisfied( s ) == SATISFIED ) {
+					
+				if (max_solutions != 0) {
+					int found = atomicAdd( nbr_found, 1 ) + 1;
+					// another thread found the last solution allowed
+					if (found > max_solutions) {
+						*cut = 1;
+						break;
+					}
+					limit = (found == max_solutions);
 				}
+				
+				++nb_sol;
+
 			}
+			
+			--i;
+			continue;
 		}
-
-		if ( g[ tab_positions[ 0 ]._y ][ tab_positions[ 0 ]._x ] > MAX_VAL) break;
 		
-		int sat = GPU_Grid_satisfied( g );
+		int y = tab_positions[ i ]._y;
+		int x = tab_positions[ i ]._x;
+		int b = gpu_grid_blk[ Grid_cell_of( y, x ) ];
+		GridElementType v = Grid_get( g, y, x );
 		
+		if (v != ZERO) {
+			GPU_GridState_remove( s, y, x, b, v );
+		}
 		
-		if ( sat  != UNSATISFIED ) {
+		++v;
+		while ((v <= MAX_VAL) and !GPU_GridState_can_place( s, y, x, b, v )) {
+			++v;
+		}
+		
+		if (v > MAX_VAL) {
+			Grid_set( g, y, x, ZERO );
+			--i;
+		} else if (limit) {
+			*cut = 1;
+			break;
+		} else {
+			Grid_set( g, y, x, v );
+			GPU_GridState_place( s, y, x, b, v );
 			++i;
 		}
-				
-		if (i == m) {
-			
-			if ( GPU_Grid_satisfied( g ) == SATISFIED ) {
-					
-				++nb_sol;
-
-			}
-			
-			--i;		
-		}	
 		
 	}
 	
@@ -165,7 +211,10 @@ void kernel_Grid_solve_iterative( int nbr_grids,
 	Grid *tab_grids, 
 	int *tab_nbr_solutions,
 	int nbr_positions, 
-	Position* tab_positions ) {
+	Position* tab_positions,
+	int *nbr_found,
+	int *cut,
+	int max_solutions ) {
 
 
 	int gtid = blockDim.x * blockIdx.x + threadIdx.x;
@@ -177,7 +226,10 @@ void kernel_Grid_solve_iterative( int nbr_grids,
 			tab_grids[ gtid ],
 			tab_nbr_solutions,
 			nbr_positions, 
-			tab_positions 
+			tab_positions,
+			nbr_found,
+			cut,
+			max_solutions
 		);
 		
 	}
@@ -186,7 +238,9 @@ void kernel_Grid_solve_iterative( int nbr_grids,
 }
 
 /**
- * Iteratively solve the Sudoku given the list of zero positions
+ * Iteratively solve the Sudoku for a set of seed grids, the number
+ * of solutions found is added to nbr_solutions and cut_flag is set
+ * if a thread stopped the search with branches left
  *
  */
 void Grid_solve_iterative( int nbr_grids, Grid *cpu_tab_grids ) {
@@ -233,6 +287,19 @@ void Grid_solve_iterative( int nbr_grids, Grid *cpu_tab_grids ) {
 	cume_check( cudaMalloc( (void **) &gpu_tab_nbr_solutions, nbr_grids * sizeof( int ) ) );
 	//cume_check( cudaMemset( gpu_tab_nbr_solutions, 0, nbr_grids * sizeof( int ) ) );
 
+	// solutions still allowed for this chunk, shared by all threads
+	int max_chunk_solutions = (max_solutions != 0) ? static_cast<int>( max_solutions - nbr_solutions ) : 0;
+	
+	int *gpu_nbr_found;
+	
+	cume_check( cudaMalloc( (void **) &gpu_nbr_found, sizeof( int ) ) );
+	cume_check( cudaMemset( gpu_nbr_found, 0, sizeof( int ) ) );
+
+	int *gpu_cut;
+	
+	cume_check( cudaMalloc( (void **) &gpu_cut, sizeof( int ) ) );
+	cume_check( cudaMemset( gpu_cut, 0, sizeof( int ) ) );
+
 
 	Grid *gpu_tab_grids;
 	
@@ -260,7 +327,10 @@ void Grid_solve_iterative( int nbr_grids, Grid *cpu_tab_grids ) {
 		gpu_tab_grids, 
 		gpu_tab_nbr_solutions, 
 		nbr_positions,
-		gpu_tab_positions 
+		gpu_tab_positions,
+		gpu_nbr_found,
+		gpu_cut,
+		max_chunk_solutions
 	);
 	cume_check_kernel();
 	
@@ -271,8 +341,16 @@ void Grid_solve_iterative( int nbr_grids, Grid *cpu_tab_grids ) {
 	//cout << "solutions:" << endl;
 	//copy( &cpu_tab_nbr_solutions[ 0 ], &cpu_tab_nbr_solutions[ nbr_grids ], ostream_iterator<int>( cout, " ") ); 
 	
-	nbr_solutions = std::accumulate( &cpu_tab_nbr_solutions[ 0 ], &cpu_tab_nbr_solutions[ nbr_grids ], 0 );
+	nbr_solutions += std::accumulate( &cpu_tab_nbr_solutions[ 0 ], &cpu_tab_nbr_solutions[ nbr_grids ], 0 );
 	
+	int cpu_cut = 0;
+	
+	cume_check( cudaMemcpy( &cpu_cut, gpu_cut, sizeof( int ), D2H) );
+	
+	if (cpu_cut != 0) cut_flag = true;
+	
+	cudaFree( gpu_cut );
+	cudaFree( gpu_nbr_found );
 	cudaFree( gpu_tab_positions );
 	cudaFree( gpu_tab_grids );
 	cudaFree( gpu_tab_nbr_solutions );
@@ -281,41 +359,6 @@ void Grid_solve_iterative( int nbr_grids, Grid *cpu_tab_grids ) {
 }
 
 
-/**
- * Recursively instantiate some cells
- *
- */
-void fill_grids( Grid *tab_grids, int nbr_blocks, 
-		vector< BlockCost >& blocks_costs, int& grid_id, int n ) {
-	
-	if ( n >= nbr_blocks ) {
-	
-		for (int i = 0; i < n; ++i) {
-
-			int block = blocks_costs[ i ]._block;
-			vector<int>& values = blocks_costs[ i ]._values;
-			
-			Grid_fill_block( tab_grids[ grid_id ], block, values );
-			
-		}
-		
-		++grid_id;
-		
-	} else {
-	
-		vector<int>& values = blocks_costs[ n ]._values;
-		
-		do {
-		
-			fill_grids( tab_grids, nbr_blocks, blocks_costs, grid_id, n + 1 );
-			
-		} while ( next_permutation( values.begin(), values.end() ) );
-		
-	}
-	
-}
-
-
 /**
  * main function
  *
@@ -327,11 +370,15 @@ int main( int argc, char *argv[] ) {
 		
 	static struct option long_options[] = {
 	
-		{ "verbose-level", required_argument, 0,  0 },
-		{ "input", required_argument, 0,  0 }, 
-		{ "blocks", required_argument, 0,  0 }, 
-		{ "reverse", no_argument, 0, 0 }, 
-		{ "print-first", no_argument, 0, 0 },
+		{ "verbose-level", required_argument, 0, 'v' },
+		{ "input", required_argument, 0, 'i' }, 
+		{ "kernel", required_argument, 0, 'k' },
+		{ "blocks", required_argument, 0, 'b' }, 
+		{ "auto-split", no_argument, 0, 'a' },
+		{ "frontier", required_argument, 0, 'F' },
+		{ "reverse", no_argument, 0, 'r' }, 
+		{ "print-first", no_argument, 0, 'f' },
+		{ "max-solutions", required_argument, 0, 'n' },
 		{ 0, 0, 0, 0 }
 		
 	};
@@ -339,7 +386,7 @@ int main( int argc, char *argv[] ) {
 	int option_index = 0;
 	while (true) {
 	
-		int c = getopt_long( argc, argv, "v:i:b:rf", long_options, &option_index );
+		int c = getopt_long( argc, argv, "v:i:b:arfk:n:F:", long_options, &option_index );
 	
 		if (c == -1) break;
 
@@ -352,6 +399,13 @@ int main( int argc, char *argv[] ) {
 				input_file_name = optarg;
 				break;
 					
+			case 'k':
+				if (!Grid_select_kernel( optarg )) {
+					cerr << "error: kernel '" << optarg << "' is unknown or not supported" << endl;
+					exit( EXIT_FAILURE );
+				}
+				break;
+					
 			case 'r':
 				reverse_flag = true;
 				break;
@@ -360,10 +414,22 @@ int main( int argc, char *argv[] ) {
 				nbr_blocks = atoi( optarg );
 				break;	
 			
+			case 'a':
+				auto_split_flag = true;
+				break;
+			
+			case 'F':
+				frontier_size = atol( optarg );
+				break;
+			
 			case 'f': 
 				print_first_flag = true;
 				break;
 				
+			case 'n':
+				max_solutions = atol( optarg );
+				break;
+				
 			default:
 				cerr << "Unknown option	!" << endl;
 				exit( EXIT_FAILURE );
@@ -373,6 +439,8 @@ int main( int argc, char *argv[] ) {
 		
 	srand( time( nullptr ) );
 	
+	cume_check( GPU_Grid_init_tables() );
+	
 	Grid initial_grid;
 	
 	Grid_init( initial_grid );
@@ -391,27 +459,30 @@ int main( int argc, char *argv[] ) {
 	
 
 	
+	bool read_flag = false;
+	
 	if (input_file_name.size() != 0) {
 		
 		cout << "- read file " << input_file_name << endl;
 
-		ifstream ifs( input_file_name );
-				
-		if (ifs.is_open()) {
-
-			std::string str( (std::istreambuf_iterator<char>(ifs)),
-                 std::istreambuf_iterator<char>());
-                 
-            input = str;     
-
-		} else {
+		PuzzleFile pf;
 		
-			cout << "! error: could not open file '" << input_file_name << "'" << endl;
+		if (PuzzleFile_open( pf, input_file_name.c_str() )) {
 			
+			read_flag = PuzzleFile_next( pf, initial_grid );
+			PuzzleFile_close( pf );
+				
+		}
+		
+		if (!read_flag) {
+			cout << "! error: could not read grid from file '" << input_file_name << "'" << endl;
 		}
+		
 	}
 	
-	Grid_fill( initial_grid, input );
+	if (!read_flag) {
+		Grid_fill( initial_grid, input );
+	}
 	
 	if (verbose_level >= 1) {
 		cout << endl;
@@ -429,6 +500,38 @@ int main( int argc, char *argv[] ) {
 	
 		cout << "! error: can't solve a grid that is already UNSATISFIED" << endl;
 			
+	} else if (frontier_size > 0) {
+	
+		//
+		// The grids of the frontier all have the same empty cells,
+		// they are sent to the GPU by chunks like the seed grids
+		//
+		
+		const size_t MAX_GRIDS_PER_KERNEL = 65536;
+		
+		cout << "- frontier of at least " << frontier_size << " node(s)" << endl;
+		
+		Frontier frontier;
+		
+		Frontier_expand( frontier, initial_grid, frontier_size, reverse_flag );
+		
+		size_t k = 0;
+		
+		while ((k < frontier._grids.size()) and 
+				((max_solutions == 0) or (nbr_solutions < max_solutions))) {
+		
+			size_t nbr_grids = std::min( MAX_GRIDS_PER_KERNEL, frontier._grids.size() - k );
+			
+			Grid_solve_iterative( static_cast<int>( nbr_grids ), &frontier._grids[ k ] );
+			
+			k += nbr_grids;
+		}
+		
+		// the limit was reached before the last chunks
+		if (k < frontier._grids.size()) cut_flag = true;
+		
+		cout << "- number of grids of the frontier=" << frontier._grids.size() << endl;
+		
 	} else {
 	
 		vector< BlockCost > blocks_costs;
@@ -455,9 +558,23 @@ int main( int argc, char *argv[] ) {
 		// we estimate the number of grids to use and fill
 		//
 				
+		// one seed grid for each thread that the GPU can run at the
+		// same time
+		if (auto_split_flag) {
+			cudaDeviceProp prop;
+			cume_check( cudaGetDeviceProperties( &prop, 0 ) );
+			uint64_t nbr_threads = static_cast<uint64_t>( prop.multiProcessorCount ) * prop.maxThreadsPerMultiProcessor;
+			nbr_blocks = SeedGenerator_select_blocks( initial_grid, blocks_costs, nbr_threads );
+			cout << "- automatic split for " << nbr_threads << " GPU thread(s) with ";
+			cout << nbr_blocks << " block(s)" << endl;
+			cout << endl;
+		}
+		
 		cout << "- evaluate number of permutations:" << endl;
 				
-		int total_permutations = 1;
+		nbr_blocks = std::min( nbr_blocks, static_cast<int>( blocks_costs.size() ) );
+		
+		uint64_t total_permutations = 1;
 		
 		for (int i = 0; i < nbr_blocks; ++i) {
 		
@@ -493,39 +610,51 @@ int main( int argc, char *argv[] ) {
 		
 	
 		//
-		// Now we create the grids from the initial grid and fill them
+		// The seed grids are generated on demand from the initial grid,
+		// only the grids that don't violate the constraints are kept.
+		// They are sent to the GPU by chunks so that the memory used
+		// doesn't depend on the number of blocks
 		//
-		int nbr_grids = total_permutations;
 		
-		Grid *tab_grids = new Grid[ nbr_grids ];
+		const int MAX_GRIDS_PER_KERNEL = 65536;
 		
-		for (int i = 0; i < nbr_grids; ++i) {
+		SeedGenerator *generator = new SeedGenerator;
 		
-			Grid_copy( tab_grids[ i ], initial_grid );
-			
-		}
+		SeedGenerator_init( *generator, initial_grid, blocks_costs, nbr_blocks );
 		
-		int grid_id = 0;
+		Grid *tab_grids = new Grid[ MAX_GRIDS_PER_KERNEL ];
 		
-		fill_grids( tab_grids, nbr_blocks, blocks_costs, grid_id, 0 );
+		while ((max_solutions == 0) or (nbr_solutions < max_solutions)) {
 		
-		if (verbose_level >= 2) {
-
-			cout << "- all grids" << endl;
+			int nbr_grids = 0;
 			
-			for (int i = 0; i < nbr_grids; ++i) {
-			
-				cout << i << endl << tab_grids[ i ] << endl;
+			while ((nbr_grids < MAX_GRIDS_PER_KERNEL) and 
+					SeedGenerator_next( *generator, tab_grids[ nbr_grids ] )) {
+				++nbr_grids;
 			}
+			
+			if (nbr_grids == 0) break;
+			
+			Grid_solve_iterative( nbr_grids, tab_grids );
+			
+		}
 		
-		}	
-				
-		Grid_solve_iterative( nbr_grids, tab_grids );
+		// the limit was reached before the last seed grids
+		if (!generator->_finished) cut_flag = true;
+		
+		cout << "- number of seed grids=" << generator->_nbr_seeds << endl;
+		
+		delete [] tab_grids;
+		delete generator;
 		
 	}	
 	
 	cout << endl;	
 	cout << "- number of solutions=" << nbr_solutions << endl;
+	
+	if (cut_flag) {
+		cout << "- search stopped after " << max_solutions << " solution(s)" << endl;
+	}
 		
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,296 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+
+  See the LICENSE file.
+
+=====================================================================
+*/
+
+#include <thread>
+#include <omp.h>
+#include "work_stealing.h"
+#include "propagation.h"
+
+void WorkStealing_init( WorkStealing& ws, int nbr_workers,
+		SeedGenerator *generator, SearchLimit *limit ) {
+
+	ws._nbr_workers = nbr_workers;
+	ws._deques = new WorkDeque[ nbr_workers ];
+
+	for (int w = 0; w < nbr_workers; ++w) {
+		ws._deques[ w ]._nbr_solutions = 0;
+		ws._deques[ w ]._nbr_nodes = 0;
+		ws._deques[ w ]._nbr_steals = 0;
+		SearchStats_init( ws._deques[ w ]._stats );
+	}
+
+	ws._nbr_idle = 0;
+	ws._nbr_pending = 0;
+	ws._generator = generator;
+	ws._limit = limit;
+	ws._callback = nullptr;
+	ws._data = nullptr;
+
+}
+
+
+void WorkStealing_free( WorkStealing& ws ) {
+
+	delete [] ws._deques;
+	ws._deques = nullptr;
+
+}
+
+
+void WorkStealing_push( WorkStealing& ws, int worker, Grid& g ) {
+
+	WorkDeque& q = ws._deques[ worker % ws._nbr_workers ];
+
+	SearchNode node;
+	Grid_copy( node._grid, g );
+	node._depth = 0;
+
+	++ws._nbr_pending;
+
+	std::lock_guard<std::mutex> lock( q._mutex );
+	q._nodes.push_back( node );
+
+}
+
+/**
+ * Return true if the maximum number of solutions is reached
+ */
+static inline bool WorkStealing_stop( WorkStealing& ws ) {
+
+	return (ws._limit != nullptr) and SearchLimit_stop( *ws._limit );
+
+}
+
+/**
+ * Take the deepest node of the queue of worker w
+ */
+static bool WorkStealing_pop( WorkStealing& ws, int w, SearchNode& node ) {
+
+	WorkDeque& q = ws._deques[ w ];
+
+	std::lock_guard<std::mutex> lock( q._mutex );
+
+	if (q._nodes.empty()) return false;
+
+	node = q._nodes.back();
+	q._nodes.pop_back();
+
+	return true;
+
+}
+
+/**
+ * Take next seed of the generator
+ */
+static bool WorkStealing_next_seed( WorkStealing& ws, SearchNode& node ) {
+
+	if (ws._generator == nullptr) return false;
+
+	// the node is pending before the generator could be seen as
+	// empty by another worker
+	++ws._nbr_pending;
+
+	if (!SeedGenerator_next( *ws._generator, node._grid )) {
+		--ws._nbr_pending;
+		return false;
+	}
+
+	node._depth = 0;
+
+	return true;
+
+}
+
+/**
+ * Take the shallowest node of the queue of another worker, the
+ * victims are visited in turn starting after worker w
+ */
+static bool WorkStealing_steal( WorkStealing& ws, int w, SearchNode& node ) {
+
+	for (int k = 1; k < ws._nbr_workers; ++k) {
+
+		WorkDeque& q = ws._deques[ (w + k) % ws._nbr_workers ];
+
+		std::lock_guard<std::mutex> lock( q._mutex );
+
+		if (q._nodes.empty()) continue;
+
+		node = q._nodes.front();
+		q._nodes.pop_front();
+
+		++ws._deques[ w ]._nbr_steals;
+
+		return true;
+	}
+
+	return false;
+
+}
+
+/**
+ * Push the values of the candidates in cell (y,x) as new nodes in
+ * the queue of worker w if some workers are idle and the queue is
+ * empty. Return true if the node was split.
+ */
+static bool WorkStealing_split( WorkStealing& ws, int w, Grid& g, int y, int x,
+		GridMask candidates, int depth ) {
+
+	if (ws._nbr_idle.load( std::memory_order_relaxed ) == 0) return false;
+
+	WorkDeque& q = ws._deques[ w ];
+
+	std::lock_guard<std::mutex> lock( q._mutex );
+
+	if (!q._nodes.empty()) return false;
+
+	while (candidates != 0) {
+
+		GridElementType v = __builtin_ctz( candidates );
+		candidates &= candidates - 1;
+
+		SearchNode node;
+		Grid_copy( node._grid, g );
+		Grid_set( node._grid, y, x, v );
+		node._depth = depth + 1;
+
+		++ws._nbr_pending;
+		q._nodes.push_back( node );
+	}
+
+	return true;
+
+}
+
+/**
+ * Recursive search with the Minimum Remaining Values heuristic
+ */
+static void WorkStealing_search( WorkStealing& ws, int w, Grid& g, GridState& s,
+		Trail& t, int depth ) {
+
+	if ((ws._limit != nullptr) and SearchLimit_cut( *ws._limit )) return;
+
+	WorkDeque& q = ws._deques[ w ];
+
+	++q._nbr_nodes;
+
+	int y, x;
+	int count = GridState_select_mrv( s, y, x );
+
+	if (count < 0) {
+
+		if ((ws._limit != nullptr) and !SearchLimit_add_solution( *ws._limit )) return;
+
+		++q._nbr_solutions;
+		if (ws._callback != nullptr) ws._callback( g, ws._data );
+		return;
+
+	}
+
+	GridMask candidates = GridState_candidates( s, y, x, Grid_block_of( y, x ) );
+
+	SearchStats_node( q._stats, depth );
+	SearchStats_check( q._stats );
+	if (candidates == 0) SearchStats_backtrack( q._stats );
+
+	while (candidates != 0) {
+
+		GridElementType v = __builtin_ctz( candidates );
+		candidates &= candidates - 1;
+
+		SearchStats_branch( q._stats, depth );
+
+		// give the other values to the idle workers
+		if ((candidates != 0) and WorkStealing_split( ws, w, g, y, x, candidates, depth )) {
+			candidates = 0;
+		}
+
+		int mark = t._size;
+
+		Grid_assign( g, s, t, y, x, v );
+
+		WorkStealing_search( ws, w, g, s, t, depth + 1 );
+
+		Trail_undo( g, s, t, mark );
+
+	}
+
+}
+
+
+long WorkStealing_solve( WorkStealing& ws,
+		WorkStealing_SolutionCallback callback, void *data ) {
+
+	ws._callback = callback;
+	ws._data = data;
+
+	#pragma omp parallel num_threads( ws._nbr_workers )
+	{
+		int w = omp_get_thread_num();
+
+		SearchNode node;
+		GridState state;
+		Trail trail;
+
+		SearchStats_start( ws._deques[ w ]._stats );
+
+		while (!WorkStealing_stop( ws )) {
+
+			bool found = WorkStealing_pop( ws, w, node ) 
+				or WorkStealing_next_seed( ws, node )
+				or WorkStealing_steal( ws, w, node );
+
+			if (!found) {
+
+				++ws._nbr_idle;
+
+				while (!found and (ws._nbr_pending.load() > 0) and !WorkStealing_stop( ws )) {
+					std::this_thread::yield();
+					found = WorkStealing_steal( ws, w, node );
+				}
+
+				--ws._nbr_idle;
+
+				if (!found) break;
+			}
+
+			// the grids pushed initially can violate the constraints
+			if (GridState_init( state, node._grid ) != UNSATISFIED) {
+
+				Trail_init( trail );
+				WorkStealing_search( ws, w, node._grid, state, trail, node._depth );
+
+			}
+
+			--ws._nbr_pending;
+		}
+
+		SearchStats_stop( ws._deques[ w ]._stats );
+	}
+
+	// nodes or seed grids left when the workers stopped
+	if ((ws._limit != nullptr) and SearchLimit_stop( *ws._limit ) and ((ws._nbr_pending.load() > 0)
+			or ((ws._generator != nullptr) and !ws._generator->_finished))) {
+		ws._limit->_cut = true;
+	}
+
+	long nbr_solutions = 0;
+	for (int w = 0; w < ws._nbr_workers; ++w) {
+		nbr_solutions += ws._deques[ w ]._nbr_solutions;
+	}
+
+	return nbr_solutions;
+
+}
@@ -0,0 +1,120 @@
+/*
+=====================================================================
+    Project: Sudoku
+     Author: Jean-Michel RICHER
+      Email: jean-michel.richer@univ-angers.fr
+ Created on: January, 2023
+=====================================================================
+  Resolution of the Sudoku puzzle based on sequential or parallel
+  implementations which can be iterative or recursive. We also
+  provide a GPU iterative version.
+=====================================================================
+*/
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include "grid.h"
+#include "grid_state.h"
+#include "seed_generator.h"
+#include "search_context.h"
+
+/**
+ * Work stealing engine for the parallel resolution.
+ *
+ * Each worker (thread) owns a double ended queue of open search
+ * nodes (grids partially filled). A worker takes the deepest node
+ * at the back of its own queue and solves it with a recursive search
+ * that uses the Minimum Remaining Values heuristic. When some workers
+ * are idle and the queue of the worker is empty, the worker splits
+ * its current node: the values not yet tried are pushed as new nodes
+ * at the back of its queue.
+ *
+ * An idle worker first takes a new seed from the generator, if any,
+ * then steals the shallowest node at the front of the queue of
+ * another worker, so that the work is split on demand rather than
+ * before the search.
+ */
+
+/**
+ * Function called for each solution found. It is called by several
+ * threads at the same time and must be thread safe.
+ */
+typedef void (*WorkStealing_SolutionCallback)( Grid& solution, void *data );
+
+/**
+ * Open search node
+ */
+typedef struct SearchNode {
+	Grid _grid;
+	int _depth;
+
+} SearchNode;
+
+/**
+ * Queue of a worker and its statistics, padded with a cache line
+ * so that the statistics of two workers are not on the same line
+ */
+typedef struct WorkDeque {
+	std::mutex _mutex;
+	std::deque< SearchNode > _nodes;
+
+	long _nbr_solutions;
+	long _nbr_nodes;
+	long _nbr_steals;
+	// statistics of the search of the worker
+	SearchStats _stats;
+
+	char _padding[ 64 ];
+
+} WorkDeque;
+
+typedef struct WorkStealing {
+	int _nbr_workers;
+	WorkDeque *_deques;
+
+	// number of workers looking for a node to steal
+	std::atomic<int> _nbr_idle;
+	// number of nodes pushed that are not solved yet
+	std::atomic<long> _nbr_pending;
+
+	// seeds given to the workers on demand, can be null
+	SeedGenerator *_generator;
+
+	// maximum number of solutions, null to find all solutions
+	SearchLimit *_limit;
+
+	WorkStealing_SolutionCallback _callback;
+	void *_data;
+
+} WorkStealing;
+
+/**
+ * Initialize engine with given number of workers, the generator
+ * of the seed grids and the maximum number of solutions. The workers
+ * stop as soon as the limit is reached and the solutions beyond the
+ * limit are not counted.
+ */
+void WorkStealing_init( WorkStealing& ws, int nbr_workers,
+	SeedGenerator *generator = nullptr, SearchLimit *limit = nullptr );
+
+/**
+ * Free the queues of the workers
+ */
+void WorkStealing_free( WorkStealing& ws );
+
+/**
+ * Push a grid as an initial node in the queue of a worker
+ */
+void WorkStealing_push( WorkStealing& ws, int worker, Grid& g );
+
+/**
+ * Solve all nodes pushed in the queues and all seeds of the
+ * generator and return the number of
+ * solutions. If the callback is not null it is called with each
+ * solution.
+ */
+long WorkStealing_solve( WorkStealing& ws,
+	WorkStealing_SolutionCallback callback = nullptr, void *data = nullptr );
+
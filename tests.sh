@@ -52,8 +52,26 @@ t=`cat ${output_dir}/gpu_par_itr.txt | grep "time=" | cut -d'=' -f 2`
 s=`cat ${output_dir}/gpu_par_itr.txt | grep "number of solutions=" | cut -d'=' -f 2`
 echo "$t      $s"
 
+/usr/bin/echo -n "CPU Dancing Links (DLX)  "
+/usr/bin/time -f "time=%U  %e" build/bin/sudoku_cpu_dlx.exe -i $problem >${output_dir}/cpu_seq_dlx.txt 2>&1
+t=`cat ${output_dir}/cpu_seq_dlx.txt | grep "time=" | cut -d'=' -f 2`
+s=`cat ${output_dir}/cpu_seq_dlx.txt | grep "number of solutions=" | cut -d'=' -f 2`
+echo "$t      $s"
+
+/usr/bin/echo -n "CPU Generic 16x16        "
+/usr/bin/time -f "time=%U  %e" build/bin/sudoku_cpu_generic.exe -x 4 -v 0 -i examples/16x16_1_solution.txt >${output_dir}/cpu_gen_16.txt 2>&1
+t=`cat ${output_dir}/cpu_gen_16.txt | grep "time=" | cut -d'=' -f 2`
+s=`cat ${output_dir}/cpu_gen_16.txt | grep "number of solutions=" | cut -d'=' -f 2`
+echo "$t      $s"
+
+/usr/bin/echo -n "CPU Generic 25x25        "
+/usr/bin/time -f "time=%U  %e" build/bin/sudoku_cpu_generic.exe -x 5 -v 0 -i examples/25x25_1_solution.txt >${output_dir}/cpu_gen_25.txt 2>&1
+t=`cat ${output_dir}/cpu_gen_25.txt | grep "time=" | cut -d'=' -f 2`
+s=`cat ${output_dir}/cpu_gen_25.txt | grep "number of solutions=" | cut -d'=' -f 2`
+echo "$t      $s"
+
 echo "---------------------------------------------------------------"
-echo "number of solutions expected is 2315"
+echo "number of solutions expected is 2315 (1 for the 16x16 and 25x25 grids)"
 echo " "
 echo "results sent to directory:"
 echo " "